@@ -0,0 +1,184 @@
+/*
+ * 在每种IoBackend上运行同一个回显TcpServer负载，比较吞吐量、往返延迟和服务端CPU时间
+ * 用法: poller_bench [连接数=500] [每连接往返次数=200] [消息字节数=64] [事件循环数=1]
+ * 服务端运行于子进程中，客户端在当前进程中以一个epoll驱动全部连接，每个连接同一时刻只有一条消息在途
+ */
+#include "CwNetWork/TcpServer.h"
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace CwNetWork;
+
+struct Backend {
+    IoBackend backend;
+    const char *name;
+};
+
+static const Backend kBackends[] = {
+        {IoBackend::EPOLL_ET, "epoll-et"},
+        {IoBackend::EPOLL_LT, "epoll-lt"},
+        {IoBackend::POLL,     "poll"},
+        {IoBackend::IO_URING, "io_uring"},
+};
+
+static const unsigned short kBasePort = 19000;
+
+struct Client {
+    int fd = -1;
+    size_t received = 0;
+    int rounds = 0;
+    chrono::steady_clock::time_point sent_at;
+};
+
+static void runServer(IoBackend backend, unsigned short port, size_t loop_num) {
+    TcpServer server(port, nullptr);
+    server.setLoopNum(loop_num);
+    server.setIoBackend(backend);
+    server.setMessageCallBack([](Socket client, const char *data, size_t len, TcpServer *const tcp_server) {
+        tcp_server->sendAll(client.getFd(), string(data, len));
+    });
+    if (!server.run()) {
+        fprintf(stderr, "server: %s\n", server.getError().c_str());
+    }
+    _exit(1);
+}
+
+static int connectTo(unsigned short port) {
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (int retry = 0; retry < 200; ++retry) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            return fd;
+        }
+        close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+static long cpuTicks(pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *file = fopen(path, "r");
+    if (file == nullptr) {
+        return 0;
+    }
+    long utime = 0, stime = 0;
+    // 跳过进程名之后的字段，utime和stime为第14、15个字段
+    fscanf(file, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %ld %ld", &utime, &stime);
+    fclose(file);
+    return utime + stime;
+}
+
+static bool runClients(unsigned short port, int conn_num, int rounds, size_t msg_size, pid_t server,
+                       const char *name) {
+    vector<Client> clients(conn_num);
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    for (int i = 0; i < conn_num; ++i) {
+        clients[i].fd = connectTo(port);
+        if (clients[i].fd == -1) {
+            fprintf(stderr, "%s: failed to connect\n", name);
+            return false;
+        }
+        struct epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.u32 = i;
+        epoll_ctl(ep, EPOLL_CTL_ADD, clients[i].fd, &event);
+    }
+    string message(msg_size, 'x');
+    vector<char> buf(msg_size > 65536 ? msg_size : 65536);
+    vector<double> latencies;
+    latencies.reserve(static_cast<size_t>(conn_num) * rounds);
+    vector<struct epoll_event> events(conn_num);
+    long cpu_begin = cpuTicks(server);
+    auto begin = chrono::steady_clock::now();
+    for (auto &client: clients) {
+        client.sent_at = chrono::steady_clock::now();
+        send(client.fd, message.data(), message.size(), MSG_NOSIGNAL);
+    }
+    int finished = 0;
+    while (finished < conn_num) {
+        int ev_num = epoll_wait(ep, events.data(), conn_num, 5000);
+        if (ev_num <= 0) {
+            fprintf(stderr, "%s: timed out waiting for echoes\n", name);
+            return false;
+        }
+        for (int i = 0; i < ev_num; ++i) {
+            Client &client = clients[events[i].data.u32];
+            ssize_t rlen = recv(client.fd, buf.data(), buf.size(), 0);
+            if (rlen <= 0) {
+                continue;
+            }
+            client.received += rlen;
+            if (client.received < msg_size) {
+                continue;
+            }
+            auto now = chrono::steady_clock::now();
+            latencies.push_back(chrono::duration<double, micro>(now - client.sent_at).count());
+            client.received = 0;
+            if (++client.rounds == rounds) {
+                ++finished;
+                continue;
+            }
+            client.sent_at = now;
+            send(client.fd, message.data(), message.size(), MSG_NOSIGNAL);
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    long cpu_ms = (cpuTicks(server) - cpu_begin) * 1000 / sysconf(_SC_CLK_TCK);
+    sort(latencies.begin(), latencies.end());
+    printf("%-10s %12.0f %10.1f %10.1f %12ld\n", name, latencies.size() / seconds,
+           latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], cpu_ms);
+    for (auto &client: clients) {
+        close(client.fd);
+    }
+    close(ep);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    int conn_num = argc > 1 ? atoi(argv[1]) : 500;
+    int rounds = argc > 2 ? atoi(argv[2]) : 200;
+    size_t msg_size = argc > 3 ? strtoul(argv[3], nullptr, 10) : 64;
+    size_t loop_num = argc > 4 ? strtoul(argv[4], nullptr, 10) : 1;
+    if (conn_num <= 0 || rounds <= 0 || msg_size == 0) {
+        fprintf(stderr, "usage: %s [connections] [rounds] [message bytes] [loops]\n", argv[0]);
+        return 1;
+    }
+    printf("%d connections x %d round trips, %zu bytes, %zu loop(s)\n", conn_num, rounds, msg_size, loop_num);
+    printf("%-10s %12s %10s %10s %12s\n", "backend", "msgs/s", "p50(us)", "p99(us)", "server cpu(ms)");
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(kBackends) / sizeof(kBackends[0]); ++i) {
+        auto port = static_cast<unsigned short>(kBasePort + i);
+        pid_t pid = fork();
+        if (pid == 0) {
+            runServer(kBackends[i].backend, port, loop_num);
+        }
+        if (!runClients(port, conn_num, rounds, msg_size, pid, kBackends[i].name)) {
+            ++failed;
+        }
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+    return failed;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Poller.h"
+
+namespace CwNetWork {
+
+    /*
+     * 基于epoll的IO多路复用模型
+     * 边沿触发时按注册时给出的EPOLLET生效，水平触发时忽略注册中的EPOLLET
+     */
+    class EpollPoller : public Poller {
+
+    public:
+
+        /**
+          * @brief  创建一个epoll对象
+          * @param  _1:是否边沿触发 _2:事件数组的初始长度，一次wait填满时翻倍
+          */
+        explicit EpollPoller(bool edge_triggered, int init_size = 128);
+
+        ~EpollPoller() override;
+
+        EpollPoller(const EpollPoller &) = delete;
+
+        EpollPoller &operator=(const EpollPoller &) = delete;
+
+        bool valid() const override { return fd_ != -1; }
+
+        bool edgeTriggered() const override { return edge_triggered_; }
+
+        bool add(int, uint32_t, void *) override;
+
+        bool mod(int, uint32_t, void *) override;
+
+        bool del(int) override;
+
+        int wait(int) override;
+
+    private:
+
+        /**
+          * @brief  调用epoll_ctl
+          * @param  _1:操作 _2:文件描述符 _3:关心的事件 _4:用户自定义类型指针
+          * @retval 是否成功
+          */
+        bool control(int, int, uint32_t, void *) const;
+
+        // epoll文件描述符
+        int fd_;
+        // 是否边沿触发
+        bool edge_triggered_;
+
+    };
+
+}
@@ -0,0 +1,640 @@
+#pragma once
+
+#include "ServerSocket.h"
+#include "Poller.h"
+#include "ConnectionSlab.h"
+#include "TimingWheel.h"
+#include "UpgradeChannel.h"
+#include "TimerQueue.h"
+#include <unordered_map>
+#include <random>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+namespace CwNetWork {
+
+    class TcpServer;
+
+    class TcpClient;
+
+    class EventLoop {
+
+    public:
+
+        // 投递到事件循环线程中执行的任务
+        using Functor = std::function<void()>;
+
+        // 广播目标连接及投递时读取的槽位代数
+        using Target = std::pair<Connection *, uint32_t>;
+
+        /**
+          * @brief  构造一个隶属于指定Tcp服务端的事件循环(Reactor)
+          * @note   每个事件循环独占一个Poller对象、一个服务端套接字和自己的客户端表
+          * @param  所属的Tcp服务端、连接接收缓冲区的初始容量
+          */
+        EventLoop(TcpServer *, size_t rbuf_size);
+
+        ~EventLoop();
+
+        EventLoop(const EventLoop &) = delete;
+
+        EventLoop &operator=(const EventLoop &) = delete;
+
+        /**
+          * @brief  创建该事件循环的Poller、唤醒描述符(eventfd)和定时器队列的timerfd
+          * @note   服务端设置了空闲超时或写停滞超时时还将创建驱动时间轮的timerfd；如果失败可通过getError方法获取失败原因
+          * @retval 是否成功初始化
+          */
+        bool init();
+
+        /**
+          * @brief  为该事件循环创建服务端套接字并加入Poller
+          * @note   如果失败可通过getError方法获取失败原因
+          * @param  _1:监听地址 _2:套接字类型 _3:等待队列最大长度 _4:是否开启SO_REUSEPORT
+          * @retval 是否成功监听
+          */
+        bool listen(const AddrInfo &, int, int, bool);
+
+        /**
+          * @brief  在指定路径上监听热升级请求
+          * @note   新进程连接该路径后由TcpServer协调各事件循环移交连接
+          * @param  Unix域套接字路径
+          * @retval 是否监听成功
+          */
+        bool listenUpgrade(const std::string &);
+
+        /**
+          * @brief  热升级时导出该事件循环的服务端套接字和全部连接
+          * @note   应在该事件循环线程中调用；导出后服务端套接字和连接从Poller上移除但描述符保持打开，
+          *         移交成功后事件循环退出时只关闭描述符而不执行关闭回调，失败时可通过resume恢复
+          * @param  _1:服务端套接字描述符 _2:连接集合
+          */
+        void handOver(std::vector<int> &, std::vector<HandoffConnection> &);
+
+        /**
+          * @brief  热升级失败后恢复监听和全部连接
+          * @note   应在该事件循环线程中调用
+          */
+        void resume();
+
+        /**
+          * @brief  接管旧进程移交的一个连接，恢复其接收和发送缓冲区
+          * @note   在事件循环运行前调用；接管的连接不使用零拷贝发送，避免与旧进程留下的发送序号冲突
+          * @param  移交的连接，其中的描述符由该事件循环接管
+          * @retval 是否接管成功，失败时已关闭其中的全部描述符
+          */
+        bool adoptClient(HandoffConnection &);
+
+        /**
+          * @brief  运行事件循环
+          * @note   该函数为阻塞函数，应在该事件循环所属的线程中调用；调用quit或排空完成后返回，
+          *         返回前关闭剩余的连接，每个连接执行一次关闭回调
+          */
+        void loop();
+
+        /**
+          * @brief  让事件循环在本轮事件处理完毕后退出
+          * @note   线程安全，只读写原子变量和eventfd，可在信号处理函数中调用
+          */
+        void quit();
+
+        /**
+          * @brief  开始排空该事件循环
+          * @note   停止接受新连接，待发送数据写完的连接以shutdown(SHUT_WR)半关闭，等待对端关闭；
+          *         到达期限后分批关闭剩余的连接，全部连接关闭后事件循环退出。
+          *         线程安全，只读写原子变量和eventfd，可在信号处理函数中调用；重复调用时保留第一次设置的期限
+          * @param  排空期限毫秒数，不大于0表示立即关闭全部连接
+          */
+        void drain(int);
+
+        /**
+          * @brief  向该事件循环管理的指定套接字描述符发送数据
+          * @note   如果对端不可写，该方法将会异步等待epoll调用
+          * @param  指定的套接字描述符、要发送的数据
+          */
+        void sendAll(int, const std::string &);
+
+        /**
+          * @brief  向该事件循环管理的指定连接发送数据
+          * @param  指定的连接、要发送的数据
+          */
+        void sendAll(Connection *, const std::string &);
+
+        /**
+          * @brief  将文件的指定区间追加到指定连接的发送缓冲区并尝试发送
+          * @note   发送缓冲区接管该文件描述符
+          * @param  _1:指定的连接 _2:文件描述符 _3:区间起始偏移 _4:区间长度
+          */
+        void sendFile(Connection *, int, off_t, size_t);
+
+        /**
+          * @brief  将管道中的指定字节数追加到指定连接的发送缓冲区并尝试发送
+          * @note   发送缓冲区接管该管道读端描述符
+          * @param  _1:指定的连接 _2:管道读端描述符 _3:字节数
+          */
+        void sendPipe(Connection *, int, size_t);
+
+        /**
+          * @brief  将一个共享数据块追加到指定连接的发送缓冲区并尝试发送，不复制数据
+          * @param  _1:指定的连接 _2:数据块
+          */
+        void sendChunk(Connection *, const OutputBuffer::Chunk &);
+
+        /**
+          * @brief  将同一个共享数据块发送给该事件循环管理的一批连接
+          * @note   已关闭或已被复用的连接被跳过
+          * @param  _1:数据块 _2:目标连接及其槽位代数
+          */
+        void broadcast(const OutputBuffer::Chunk &, const std::vector<Target> &);
+
+        /**
+          * @brief  刷新一批连接的空闲计时，相当于这些连接刚收到数据
+          * @note   已关闭或已被复用的连接被跳过
+          * @param  目标连接及其槽位代数
+          */
+        void touch(const std::vector<Target> &);
+
+        /**
+          * @brief  将同一个共享数据块发送给该事件循环管理的、满足条件的全部连接
+          * @note   先筛选出全部目标再发送，发送中触发的回调断开连接不会影响遍历
+          * @param  _1:数据块 _2:筛选条件，为空时发送给全部连接
+          */
+        void broadcast(const OutputBuffer::Chunk &, const std::function<bool(const Socket &)> &);
+
+        /**
+          * @brief  断开该事件循环管理的指定客户端连接
+          * @note   如果该文件描述符不属于该事件循环，会抛出std::out_of_range异常
+          * @param  指定的客户端文件描述符
+          */
+        void disConnect(int);
+
+        /**
+          * @brief  断开该事件循环管理的指定连接
+          * @param  指定的连接
+          */
+        void disConnect(Connection *);
+
+        /**
+          * @brief  将一个已发起非阻塞connect的主动连接注册到该事件循环，握手完成前只关心可写事件
+          * @note   应在该事件循环线程中调用；握手结果通过TcpClient::handleConnect交回。主动连接不计入连接数，
+          *         不参与广播、空闲超时、排空和热升级移交
+          * @param  _1:已发起连接的Socket对象 _2:发起连接的Tcp客户端
+          * @retval 连接指针，描述符超出连接槽容量时关闭描述符并返回nullptr
+          */
+        Connection *addOutbound(const Socket &, TcpClient *);
+
+        /**
+          * @brief  判断指定连接是否仍是该事件循环管理的同一个连接
+          * @note   文件描述符关闭后被复用时槽位代数不同，用于丢弃投递给旧连接的任务
+          * @param  连接槽、投递任务时读取的槽位代数
+          * @retval 是否仍为同一个连接
+          */
+        bool owns(const Connection *conn, uint32_t generation) const {
+            return conn->loop.load(std::memory_order_relaxed) == this &&
+                   conn->generation.load(std::memory_order_relaxed) == generation;
+        }
+
+        /**
+          * @brief  将一批已建立的连接移交给该事件循环
+          * @note   线程安全，可在其他线程(如接受连接的事件循环)中调用，整批连接只投递一次任务、唤醒一次
+          * @param  已建立连接的客户端Socket对象集合
+          */
+        void queueConnections(std::vector<Socket>);
+
+        /**
+          * @brief  连接数回落后恢复因连接数达到上限而暂停的接受
+          * @note   线程安全，未暂停时直接返回，多次调用只投递一次任务；因接受速率暂停的由事件循环自行到时恢复
+          */
+        void wakeAccept();
+
+        /**
+          * @brief  在该事件循环线程中执行任务
+          * @note   线程安全，如果当前就在该事件循环线程中则立即执行，否则投递到任务队列
+          * @param  要执行的任务
+          */
+        void runInLoop(Functor);
+
+        /**
+          * @brief  将任务投递到该事件循环的任务队列，在本轮事件处理完毕后执行
+          * @note   线程安全，必要时通过eventfd唤醒事件循环，调用方只会短暂持有入队互斥锁
+          * @param  要执行的任务
+          */
+        void queueInLoop(Functor);
+
+        /**
+          * @brief  在指定毫秒数后于该事件循环线程中执行任务
+          * @note   线程安全，从调用时刻开始计时；到期时间相同的任务按创建的先后执行，事件循环析构时未到期的任务被直接析构
+          * @param  _1:延迟毫秒数 _2:要执行的任务
+          * @retval 定时器句柄
+          */
+        TimerId runAfter(int, Functor);
+
+        /**
+          * @brief  每隔指定毫秒数于该事件循环线程中执行一次任务，直到取消
+          * @note   线程安全，首次在一个周期后执行；任务耗时超过周期时不补执行错过的次数
+          * @param  _1:周期毫秒数，不小于1 _2:要执行的任务
+          * @retval 定时器句柄
+          */
+        TimerId runEvery(int, Functor);
+
+        /**
+          * @brief  将一个已创建的定时器加入该事件循环的定时器队列
+          * @note   线程安全，不在该事件循环线程中时投递到任务队列
+          * @param  TimerQueue::newTimer创建的定时器
+          */
+        void addTimer(std::shared_ptr<Timer>);
+
+        /**
+          * @brief  判断当前线程是否为该事件循环所在的线程
+          * @retval 是否为事件循环线程
+          */
+        bool isInLoopThread() const;
+
+        /**
+          * @brief  获取当前线程正在运行的事件循环
+          * @retval 事件循环指针，不在事件循环线程中时返回nullptr
+          */
+        static EventLoop *current();
+
+        /**
+          * @brief  获取该事件循环当前管理的连接数(含尚未注册的移交连接)
+          * @retval 连接数
+          */
+        size_t getConnectionCount() const { return conn_count_.load(std::memory_order_relaxed); }
+
+        /**
+          * @brief  获取该事件循环管理的客户端对象键值对
+          * @note   线程安全，在其他线程中调用时投递到该事件循环线程中收集并阻塞等待结果；事件循环未运行时直接收集。
+          *         不要在两个事件循环线程中互相查询，否则会彼此等待
+          * @retval 已连接的客户端对象键值对
+          */
+        std::unordered_map<int, Socket> getClients();
+
+        /**
+          * @brief  获取初始化失败原因
+          * @retval 初始化失败原因的描述
+          */
+        std::string getError() const { return error_; }
+
+    private:
+
+        /**
+          * @brief  判断就绪事件的用户数据是否指向服务端套接字、唤醒描述符等非连接对象
+          * @param  就绪事件的用户数据
+          * @retval 是否为非连接对象
+          */
+        bool isControl(const void *) const;
+
+        /**
+          * @brief  处理服务端套接字上的新连接
+          * @note   每次最多接受kAcceptBudget个连接直到EAGAIN；文件描述符耗尽时借助预留描述符接受并立即关闭连接，
+          *         避免水平触发的服务端套接字空转
+          */
+        void handleAccept();
+
+        /**
+          * @brief  处理accept请求交付的新连接或错误(完成模型)
+          * @note   连接已被内核接受，不能再留在等待队列中：不可接受时暂停接受，连接暂存到恢复接受时处理
+          * @param  新连接的描述符，出错时为-errno
+          */
+        void handleAccepted(int);
+
+        /**
+          * @brief  接受暂停前暂存的连接，再次不可接受时停止
+          */
+        void acceptHeld();
+
+        /**
+          * @brief  将一个已接受的连接计入统计并交给选定的事件循环，交给其他事件循环的按目标分组暂存
+          * @param  新连接的Socket对象
+          */
+        void dispatchClient(const Socket &);
+
+        /**
+          * @brief  投递暂存的各组连接，暂停接受时再检查一次连接数
+          */
+        void finishAccept();
+
+        /**
+          * @brief  判断是否可以再接受一个连接
+          * @note   连接数(含本轮已接受但尚未投递的连接)达到上限或令牌桶中没有令牌时返回false；令牌不足时记录可恢复接受的时间。
+          *         只检查不消耗令牌，accept失败(EAGAIN、EMFILE、ECONNABORTED等)时不会白白花掉令牌
+          * @retval 是否可以接受
+          */
+        bool admit();
+
+        /**
+          * @brief  成功接受一个连接后从令牌桶中取走一个令牌
+          * @note   未设置接受速率时什么也不做
+          */
+        void spendToken();
+
+        /**
+          * @brief  将服务端套接字从Poller上移除，新连接留在内核的等待队列中
+          */
+        void pauseAccept();
+
+        /**
+          * @brief  将服务端套接字注册到Poller，Poller支持且使用默认接受回调时以accept请求接受连接
+          * @retval 是否注册成功
+          */
+        bool watchListener();
+
+        /**
+          * @brief  将服务端套接字从Poller上移除，accept请求已接受但尚未交付的连接暂存下来
+          */
+        void unwatchListener();
+
+        /**
+          * @brief  将服务端套接字重新注册到Poller，恢复接受连接
+          */
+        void resumeAccept();
+
+        /**
+          * @brief  计算Poller::wait的超时时间，取排空期限和恢复接受时间中较早的一个
+          * @retval 超时毫秒数，-1表示无限等待
+          */
+        int pollTimeout() const;
+
+        /**
+          * @brief  删除该事件循环监听的Unix域套接字文件
+          * @note   只在该事件循环确实监听过且未将服务端套接字移交给新进程时删除
+          */
+        void removeListenPath() const;
+
+        /**
+          * @brief  文件描述符耗尽时释放预留描述符，接受一个连接后立即关闭以清出等待队列，再重新占用预留描述符
+          * @retval 是否有预留描述符可用；重新占用失败时预留描述符为-1，恢复接受时再尝试占用
+          */
+        bool shedConnection();
+
+        /**
+          * @brief  读空唤醒描述符
+          */
+        void handleWakeup();
+
+        /**
+          * @brief  接受新进程的热升级连接，关闭并删除热升级监听套接字后交给TcpServer协调移交
+          */
+        void handleUpgrade();
+
+        /**
+          * @brief  将服务端套接字设为非阻塞并注册到Poller
+          * @retval 是否注册成功
+          */
+        bool registerListener();
+
+        /**
+          * @brief  处理timerfd上的事件，推进时间轮并处理到期的连接
+          */
+        void handleTimer();
+
+        /**
+          * @brief  处理空闲定时器到期的连接
+          * @note   连接在定时器挂入后仍有数据到来时只按最近活跃时间重新挂入，否则执行空闲回调或断开连接
+          * @param  客户端连接
+          */
+        void handleIdle(Connection *);
+
+        /**
+          * @brief  处理写停滞定时器到期的连接
+          * @note   定时器挂入后仍有数据写入内核时只按最近写入时间重新挂入；否则再尝试写一次，仍写不进时断开连接
+          * @param  客户端连接
+          */
+        void handleStall(Connection *);
+
+        /**
+          * @brief  开始排空或推进排空：关闭服务端套接字、半关闭已写完的连接，到达期限后分批关闭剩余的连接
+          */
+        void updateDrain();
+
+        /**
+          * @brief  排空期间已写完的连接以shutdown(SHUT_WR)半关闭写方向
+          * @param  客户端连接
+          */
+        void closeOutput(Connection *);
+
+        /**
+          * @brief  计算排空期间Poller::wait的超时时间
+          * @retval 距离排空期限的毫秒数，已到期时为0
+          */
+        int drainTimeout() const;
+
+        /**
+          * @brief  获取单调时钟下当前的时间轮刻度
+          * @retval 当前刻度
+          */
+        uint64_t currentTick() const;
+
+        /**
+          * @brief  发送缓冲区变化后更新写停滞定时器、高低水位状态和关心的事件，必要时执行水位回调
+          * @param  客户端连接
+          */
+        void updateOutput(Connection *);
+
+        /**
+          * @brief  根据连接当前状态计算应在Poller上注册的事件
+          * @note   越过高水位且设置了暂停读取时不关心可读事件；水平触发的后端和完成模型的连接仅在有待发送数据时关心可写事件，
+          *         完成模型的连接有未结束的发送请求时也不关心
+          * @param  客户端连接
+          * @retval 应注册的事件
+          */
+        uint32_t interestOf(const Connection *) const;
+
+        /**
+          * @brief  收集该事件循环管理的客户端对象键值对
+          * @note   只能在该事件循环线程中或事件循环未运行时调用
+          * @retval 已连接的客户端对象键值对
+          */
+        std::unordered_map<int, Socket> collectClients() const;
+
+        /**
+          * @brief  执行任务队列中的全部任务
+          */
+        void doPendingFunctors();
+
+        /**
+          * @brief  写唤醒描述符以唤醒阻塞在Poller::wait上的事件循环
+          */
+        void wakeup() const;
+
+        /**
+          * @brief  将一个已建立的连接注册到该事件循环
+          * @param  _1:已建立连接的客户端Socket对象 _2:是否执行连接建立回调
+          */
+        void addClient(const Socket &, bool notify = true);
+
+        /**
+          * @brief  获取该事件循环管理的指定文件描述符的连接
+          * @param  客户端套接字描述符
+          * @retval 连接指针，不属于该事件循环时返回nullptr
+          */
+        Connection *getClient(int) const;
+
+        /**
+          * @brief  按连接当前关心的事件注册到Poller，完成模型下以recv请求接收数据
+          * @param  客户端连接
+          */
+        void watch(Connection *);
+
+        /**
+          * @brief  撤销连接上未结束的请求并等待其结束，已读出的数据放入接收缓冲区，已写出的数据从发送缓冲区丢弃
+          * @note   同时将连接从Poller上移除
+          * @param  客户端连接
+          */
+        void settle(Connection *);
+
+        /**
+          * @brief  处理客户端套接字上的可读事件
+          * @param  客户端连接
+          */
+        void handleRead(Connection *);
+
+        /**
+          * @brief  处理recv请求交付的数据(完成模型)
+          * @param  _1:客户端连接 _2:收到的数据 _3:收到的字节数，0为对端关闭，负数为-errno
+          */
+        void handleReceived(Connection *, const char *, int);
+
+        /**
+          * @brief  更新最近活跃时间并交付接收缓冲区中的数据，必要时关闭连接或归还接收缓冲区
+          * @param  _1:客户端连接 _2:对端是否已关闭或出错
+          */
+        void finishRead(Connection *, bool);
+
+        /**
+          * @brief  将接收缓冲区中的数据交给回调函数
+          * @note   设置了编解码器时逐帧交付，否则交付全部数据
+          * @param  客户端连接
+          * @retval 是否遇到违反协议的数据
+          */
+        bool deliver(Connection *);
+
+        /**
+          * @brief  处理主动连接上的握手完成事件，成功时改为关心读写事件，结果交给发起连接的Tcp客户端
+          * @param  主动连接
+          */
+        void handleConnect(Connection *);
+
+        /**
+          * @brief  处理客户端套接字上的可写事件
+          * @note   完成模型下头部的内存数据块以发送请求提交，文件和管道仍同步写出
+          * @param  客户端连接
+          */
+        void handleWrite(Connection *);
+
+        /**
+          * @brief  以一个发送请求提交发送缓冲区头部连续的内存数据块(完成模型)
+          * @param  客户端连接
+          * @retval 是否已提交，头部为文件或管道时返回false
+          */
+        bool submitSend(Connection *);
+
+        /**
+          * @brief  处理发送请求的结果(完成模型)，丢弃已写出的数据并继续发送
+          * @param  _1:客户端连接 _2:写出的字节数，负数为-errno
+          */
+        void handleSent(Connection *, int);
+
+        /**
+          * @brief  执行关闭回调并释放客户端连接的全部资源
+          * @param  客户端连接
+          */
+        void closeClient(Connection *);
+
+    private:
+
+        // 所属的Tcp服务端
+        TcpServer *server_;
+        // 维护服务端套接字对象，仅监听的事件循环持有
+        std::unique_ptr<ServerSocket> server_socket_;
+        // 服务端套接字描述符，未监听时为-1
+        int listen_fd_ = -1;
+        // 文件描述符耗尽时用于接受并关闭连接的预留描述符
+        int reserve_fd_ = -1;
+        // ACCEPTOR模式下本轮接受的、按目标事件循环分组的连接
+        std::vector<std::pair<EventLoop *, std::vector<Socket>>> accepted_;
+        // accepted_中的连接数，它们还没有计入目标事件循环的连接数
+        size_t batched_ = 0;
+        // 完成模型下暂停接受时已被accept请求接受、等待恢复接受时处理的连接
+        std::vector<Socket> held_;
+        // 该事件循环的IO多路复用模型
+        std::unique_ptr<Poller> poller_;
+        // Poller是否以完成模型工作
+        bool completion_ = false;
+        // 服务端套接字是否以accept请求监听
+        bool accept_completion_ = false;
+        // Poller::settle取回的完成事件，在各次调用间复用其容量
+        std::vector<Poller::Result> settled_;
+        // 跨线程唤醒该事件循环的eventfd
+        int wakeup_fd_ = -1;
+        // 驱动时间轮的timerfd，未设置空闲超时和写停滞超时时为-1
+        int timer_fd_ = -1;
+        // 时间轮每个刻度的毫秒数
+        uint64_t tick_ms_ = 0;
+        // 空闲超时对应的刻度数
+        uint64_t idle_ticks_ = 0;
+        // 写停滞超时对应的刻度数
+        uint64_t stall_ticks_ = 0;
+        // 连接空闲超时与写停滞超时时间轮
+        std::unique_ptr<TimingWheel> wheel_;
+        // 保护任务队列的互斥锁
+        std::mutex pending_mutex_;
+        // 其他线程投递的待执行任务
+        std::vector<Functor> pending_functors_;
+        // 是否正在执行任务队列
+        bool calling_functors_ = false;
+        // 投递的任务是否还会被执行，init后为true，事件循环退出前任务队列清空后为false；由pending_mutex_保护
+        bool looping_ = false;
+        // runAfter和runEvery加入的定时器队列，其timerfd与连接共用Poller
+        TimerQueue timers_;
+        // 是否退出事件循环
+        std::atomic<bool> quit_{false};
+        // 排空期限(单调时钟毫秒数)，0表示未要求排空
+        std::atomic<int64_t> drain_deadline_{0};
+        // 是否已开始排空
+        bool draining_ = false;
+        // 热升级监听套接字，未监听时为-1
+        int upgrade_fd_ = -1;
+        // 热升级监听路径
+        std::string upgrade_path_;
+        // 连接是否已移交给新进程
+        bool handed_over_ = false;
+        // 服务端套接字是否因连接数或接受速率达到上限而从Poller上移除
+        std::atomic<bool> accept_paused_{false};
+        // 是否已投递恢复接受的任务
+        std::atomic<bool> resume_queued_{false};
+        // 因接受速率暂停时恢复接受的时间(单调时钟毫秒数)，0表示没有
+        int64_t accept_resume_at_ = 0;
+        // 监听同一端口的事件循环数，令牌桶按其均分速率
+        double listen_loops_ = 1;
+        // 令牌桶中的令牌数
+        double tokens_ = 0;
+        // 令牌桶上次补充的时间(单调时钟毫秒数)，0表示尚未使用
+        int64_t tokens_updated_ms_ = 0;
+        // 当前管理的连接数
+        std::atomic<size_t> conn_count_{0};
+        // 所属Tcp服务端的连接槽
+        ConnectionSlab *slab_ = nullptr;
+        // 该事件循环管理的连接列表，Connection::index为其下标
+        std::vector<Connection *> conns_;
+        // TcpClient发起的主动连接列表，Connection::index为其下标
+        std::vector<Connection *> outbound_;
+        // 连接接收缓冲区的初始容量
+        size_t rbuf_size_ = 4096;
+        // 生成会话随机数
+        std::mt19937 session_rng_{std::random_device{}()};
+        // 本轮就绪事件分发前记录的各连接槽位代数，与Poller的事件数组按下标对应
+        std::vector<uint32_t> generations_;
+        // 交给接收数据回调的消息，在各次回调间复用其容量
+        std::string message_;
+        // 初始化异常日志
+        std::string error_;
+
+    };
+
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace CwNetWork {
+
+    /*
+     * 发送缓冲区，由内存数据块、文件区间和管道数据组成的有序队列
+     * 内存数据块以sendmsg聚集写入，文件区间以sendfile、管道数据以splice在内核中直接写入套接字
+     * 开启零拷贝后，较大的数据块以MSG_ZEROCOPY发送，直到内核通过错误队列通知发送完成前一直持有其引用
+     */
+    class OutputBuffer {
+
+    public:
+
+        // 引用计数的只读数据块，可被多个连接的发送缓冲区共享
+        using Chunk = std::shared_ptr<const std::string>;
+
+        OutputBuffer() = default;
+
+        ~OutputBuffer() { clear(); }
+
+        OutputBuffer(const OutputBuffer &) = delete;
+
+        OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+        /**
+          * @brief  判断发送缓冲区是否为空
+          * @retval 是否为空
+          */
+        bool empty() const { return size_ == 0; }
+
+        /**
+          * @brief  获取发送缓冲区中待发送的字节数
+          * @retval 待发送的字节数
+          */
+        size_t size() const { return size_; }
+
+        /**
+          * @brief  复制一段数据并作为新的数据块追加到缓冲区末尾
+          * @param  _1:数据起始地址 _2:数据长度
+          */
+        void append(const char *, size_t);
+
+        /**
+          * @brief  将一个共享数据块的指定区间追加到缓冲区末尾，不复制数据
+          * @param  _1:数据块 _2:区间起始偏移
+          */
+        void append(Chunk, size_t offset = 0);
+
+        /**
+          * @brief  将文件的指定区间追加到缓冲区末尾，发送时以sendfile直接从页缓存写入套接字
+          * @note   缓冲区接管该文件描述符，发送完毕或丢弃时关闭
+          * @param  _1:文件描述符 _2:区间起始偏移 _3:区间长度
+          */
+        void appendFile(int, off_t, size_t);
+
+        /**
+          * @brief  将管道中的指定字节数追加到缓冲区末尾，发送时以splice直接将管道中的页移入套接字
+          * @note   缓冲区接管该管道读端描述符，发送完毕或丢弃时关闭
+          * @param  _1:管道读端描述符 _2:字节数
+          */
+        void appendPipe(int, size_t);
+
+        /**
+          * @brief  将缓冲区头部的数据写入套接字
+          * @note   头部为内存数据块时以一次sendmsg聚集尽可能多的连续数据块，后面紧跟文件或管道时带MSG_MORE；
+          *         头部为文件或管道时调用一次sendfile或splice。文件被截断或管道写端关闭导致数据不足时，
+          *         丢弃该段剩余的字节并返回0。使用MSG_NOSIGNAL，但sendfile和splice在对端关闭时仍会产生SIGPIPE
+          * @param  _1:套接字描述符 _2:出错时保存errno
+          * @retval 写入的字节数，出错时返回-1
+          */
+        ssize_t writeTo(int, int *);
+
+        /**
+          * @brief  收集头部连续的内存数据块，供异步提交的发送请求使用
+          * @note   聚集规则与writeTo相同，不使用零拷贝；数据块在retrieve丢弃之前保持有效
+          * @param  _1:保存数据块的数组 _2:数组长度 _3:后面是否紧跟文件或管道
+          * @retval 收集到的数据块数，头部为文件或管道时返回0
+          */
+        size_t gather(struct iovec *, size_t, bool *) const;
+
+        /**
+          * @brief  从缓冲区头部丢弃已由发送请求写入套接字的字节数
+          * @param  已写入的字节数
+          */
+        void retrieve(size_t len) { consume(len); }
+
+        /**
+          * @brief  按发送顺序遍历尚未发送的各段，如热升级时导出发送缓冲区
+          * @param  回调 => void(const Chunk &, size_t offset, size_t remain, int fd, bool pipe)，
+          *         文件和管道段的数据块为空，offset为文件偏移；缓冲区仍持有各段的描述符
+          */
+        template<typename Visitor>
+        void forEach(Visitor visitor) const {
+            for (size_t i = head_; i < segments_.size(); ++i) {
+                const Segment &segment = segments_[i];
+                visitor(segment.chunk, segment.offset, segment.remain, segment.fd, segment.pipe);
+            }
+        }
+
+        /**
+          * @brief  设置以MSG_ZEROCOPY发送的数据块长度阈值
+          * @note   套接字须已开启SO_ZEROCOPY；0表示关闭
+          * @param  剩余长度不小于该值的数据块以零拷贝发送
+          */
+        void setZeroCopyThreshold(size_t threshold) { zerocopy_threshold_ = threshold; }
+
+        /**
+          * @brief  设置是否以记录为单位发送
+          * @note   用于SOCK_SEQPACKET等保留记录边界的套接字，每次追加的数据作为一条记录单独发送，不与相邻数据合并
+          * @param  是否以记录为单位发送
+          */
+        void setPacketMode(bool packet) { packet_ = packet; }
+
+        /**
+          * @brief  获取以MSG_ZEROCOPY发送的数据块长度阈值
+          * @retval 阈值，0表示未开启
+          */
+        size_t zeroCopyThreshold() const { return zerocopy_threshold_; }
+
+        /**
+          * @brief  判断是否有已交给内核、尚未收到完成通知的零拷贝发送
+          * @retval 是否有未完成的零拷贝发送
+          */
+        bool zeroCopyPending() const { return !zerocopy_pending_.empty(); }
+
+        /**
+          * @brief  读空套接字错误队列中的零拷贝完成通知并释放对应的数据块
+          * @note   内核回退为复制发送(如回环网卡)时该缓冲区不再使用零拷贝；
+          *         没有未完成的发送时也会读空，如热升级后旧进程的发送留下的通知
+          * @param  套接字描述符
+          * @retval 是否读到了完成通知
+          */
+        bool reapZeroCopy(int);
+
+        /**
+          * @brief  丢弃缓冲区中的全部数据，释放占用的内存并关闭接管的描述符
+          * @note   同时释放尚未收到完成通知的零拷贝数据块，调用前应确保内核已不再引用它们
+          */
+        void clear();
+
+    private:
+
+        struct Segment {
+            // 数据块，文件和管道段为空
+            Chunk chunk;
+            // 尚未发送部分在数据块或文件中的起始偏移
+            size_t offset;
+            // 尚未发送的字节数
+            size_t remain;
+            // 文件或管道描述符，内存数据块为-1
+            int fd;
+            // 是否为管道
+            bool pipe;
+        };
+
+        /**
+          * @brief  以一次sendmsg聚集写入头部连续的内存数据块
+          * @note   头部数据块达到零拷贝阈值时只聚集同样达到阈值的数据块并以MSG_ZEROCOPY发送，否则只聚集未达到阈值的
+          * @param  套接字描述符
+          * @retval sendmsg的返回值
+          */
+        ssize_t writeChunks(int);
+
+        /**
+          * @brief  从缓冲区头部丢弃指定字节数的已发送数据
+          * @param  已发送的字节数
+          */
+        void consume(size_t);
+
+        /**
+          * @brief  丢弃头部的一段，关闭其接管的描述符
+          */
+        void pop();
+
+        // 数据块队列，head_之前的元素已发送完毕
+        std::vector<Segment> segments_;
+        // 第一个未发送数据块的下标
+        size_t head_ = 0;
+        // 待发送的字节数
+        size_t size_ = 0;
+        // 以MSG_ZEROCOPY发送的数据块长度阈值，0表示关闭
+        size_t zerocopy_threshold_ = 0;
+        // 是否每次只发送一个数据块以保留记录边界
+        bool packet_ = false;
+        // 下一次零拷贝发送的序号，与内核为该套接字分配的序号一致
+        uint32_t zerocopy_next_ = 0;
+        // 尚未收到完成通知的零拷贝发送的序号及其引用的数据块
+        std::vector<std::pair<uint32_t, Chunk>> zerocopy_pending_;
+
+    };
+
+}
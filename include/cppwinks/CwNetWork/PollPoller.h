@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Poller.h"
+#include <poll.h>
+
+namespace CwNetWork {
+
+    /*
+     * 基于poll(2)的IO多路复用模型，只支持水平触发
+     * 每次wait需要将全部pollfd拷贝进内核并线性扫描，适合连接数很少的场景
+     */
+    class PollPoller : public Poller {
+
+    public:
+
+        /**
+          * @brief  创建一个poll对象
+          * @param  事件数组的初始长度
+          */
+        explicit PollPoller(int init_size = 128) : Poller(init_size) {}
+
+        bool valid() const override { return true; }
+
+        bool edgeTriggered() const override { return false; }
+
+        bool add(int, uint32_t, void *) override;
+
+        bool mod(int, uint32_t, void *) override;
+
+        bool del(int) override;
+
+        int wait(int) override;
+
+    private:
+
+        // 传给poll的描述符数组
+        std::vector<struct pollfd> pollfds_;
+        // 与pollfds_下标对应的用户自定义类型指针
+        std::vector<void *> ptrs_;
+        // 以文件描述符为下标的pollfds_下标，未监听为-1
+        std::vector<int> index_;
+
+    };
+
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace CwNetWork {
+
+    /*
+     * 事件循环使用的IO多路复用后端
+     * EPOLL_ET: 边沿触发的epoll  EPOLL_LT: 水平触发的epoll，仅在有待发送数据时关心可写事件
+     * POLL: poll(2)，适合连接数很少的场景
+     * IO_URING: 服务端套接字和连接分别以多次触发的accept、recv请求直接交付新连接和数据，内存数据以发送请求提交，
+     *           其余描述符以IORING_OP_POLL_ADD监听；请求的增删与等待合并为一次io_uring_enter。
+     *           需要内核支持IORING_FEAT_EXT_ARG(5.11)，不支持多次触发的recv(6.0之前)时只使用IORING_OP_POLL_ADD
+     */
+    enum class IoBackend {
+        EPOLL_ET, EPOLL_LT, POLL, IO_URING
+    };
+
+    /*
+     * IO多路复用模型的抽象接口，就绪事件统一以epoll_event的形式返回
+     * 事件数组随就绪事件数自动扩容，单次wait返回的事件数不受固定上限约束
+     */
+    class Poller {
+
+    public:
+
+        /*
+         * 事件的类型，只有以完成模型工作的后端(completionBased返回true)会产生READY以外的类型
+         * READY: 就绪事件  ACCEPT: 服务端套接字上接受了一个连接  RECV: 连接上收到了数据、对端关闭或出错
+         * SEND: 一次发送请求结束
+         */
+        enum class Completion : uint8_t {
+            READY, ACCEPT, RECV, SEND
+        };
+
+        // 完成事件的结果
+        struct Result {
+            // 事件的类型
+            Completion type = Completion::READY;
+            // ACCEPT为新连接的描述符，RECV为收到的字节数(0表示对端关闭)，SEND为写入的字节数；出错时为-errno
+            int res = 0;
+            // RECV收到的数据，在下一次wait之前有效
+            const char *data = nullptr;
+        };
+
+        // 单次发送请求最多聚集的数据块数
+        static const size_t kMaxSendIov = 64;
+
+        /**
+          * @brief  创建指定后端的IO多路复用模型
+          * @param  IoBackend
+          * @retval Poller对象，内核不支持该后端或创建失败时返回nullptr
+          */
+        static std::unique_ptr<Poller> newPoller(IoBackend);
+
+        virtual ~Poller() = default;
+
+        /**
+          * @brief  判断该对象是否创建成功
+          * @retval 是否可用
+          */
+        virtual bool valid() const = 0;
+
+        /**
+          * @brief  判断该后端对带EPOLLET的注册是否按边沿触发处理
+          * @note   返回false时使用者应只在有待发送数据时关心可写事件，避免忙等
+          * @retval 是否边沿触发
+          */
+        virtual bool edgeTriggered() const = 0;
+
+        /**
+          * @brief  开始监听指定的文件描述符
+          * @param  要加入检测的文件描述符、关心的事件、用户自定义类型指针
+          * @retval 是否成功
+          */
+        virtual bool add(int, uint32_t, void *) = 0;
+
+        /**
+          * @brief  修改指定文件描述符关心的事件
+          * @param  要修改的文件描述符、关心的事件、用户自定义类型指针
+          * @retval 是否成功
+          */
+        virtual bool mod(int, uint32_t, void *) = 0;
+
+        /**
+          * @brief  停止监听指定的文件描述符
+          * @note   该函数不会关闭该fd，请手动关闭
+          * @param  要删除的fd
+          * @retval 是否成功
+          */
+        virtual bool del(int) = 0;
+
+        /**
+          * @brief  等待I/O事件
+          * @param  参数timeout是超时时间(毫秒，0会立即返回，-1是永久阻塞)
+          * @retval 就绪事件个数，出错返回-1
+          */
+        virtual int wait(int) = 0;
+
+        /**
+          * @brief  判断该后端是否以完成模型交付新连接、数据和发送结果
+          * @note   返回false时addListener、addReceiver和send均不可用
+          * @retval 是否支持完成模型
+          */
+        virtual bool completionBased() const { return false; }
+
+        /**
+          * @brief  以多次触发的accept请求监听服务端套接字，每接受一个连接产生一个ACCEPT事件
+          * @note   新连接已设置SOCK_NONBLOCK和SOCK_CLOEXEC；停止监听时应调用settle取回已接受但尚未交付的连接
+          * @param  服务端套接字描述符、用户自定义类型指针
+          * @retval 是否成功，不支持时返回false，调用方应改用add
+          */
+        virtual bool addListener(int, void *) { return false; }
+
+        /**
+          * @brief  开始监听指定的流式套接字，关心可读事件时以多次触发的recv请求直接交付数据(RECV事件)
+          * @note   其余事件仍以就绪事件交付；mod去掉EPOLLIN时撤销recv请求，已读出的数据仍会交付
+          * @param  要加入检测的文件描述符、关心的事件、用户自定义类型指针
+          * @retval 是否成功，不支持时返回false，调用方应改用add
+          */
+        virtual bool addReceiver(int, uint32_t, void *) { return false; }
+
+        /**
+          * @brief  提交一个聚集发送请求，结束时产生一个SEND事件
+          * @note   只用于以addReceiver注册的描述符，同一时刻只能有一个未结束的发送请求；
+          *         请求结束或settle返回前数据必须保持有效
+          * @param  _1:文件描述符 _2:数据块数组 _3:数据块数，不超过kMaxSendIov _4:send的flags
+          * @retval 是否成功加入提交队列
+          */
+        virtual bool send(int, const struct iovec *, size_t, int) { return false; }
+
+        /**
+          * @brief  停止监听指定的文件描述符，撤销其上全部未结束的请求并等待它们结束
+          * @note   用于关闭或移交前确定内核已不再引用发送的数据，并取回已读出的数据和已接受的连接；
+          *         该描述符尚未交付的完成事件按原顺序追加到结果中，其他描述符的事件留待下一次wait交付
+          * @param  _1:文件描述符 _2:保存尚未交付的完成事件
+          */
+        virtual void settle(int fd, std::vector<Result> &) { del(fd); }
+
+        /**
+          * @brief  获取第index个就绪事件的引用
+          * @param  index索引，必须小于最近一次wait的返回值
+          * @retval 对应的epoll_event结构体的引用
+          */
+        const struct epoll_event &operator[](int index) const { return events_[index]; }
+
+        /**
+          * @brief  获取第index个事件的完成结果
+          * @note   只在completionBased返回true时可用；就绪事件的类型为READY
+          * @param  index索引，必须小于最近一次wait的返回值
+          * @retval 完成结果的引用
+          */
+        const Result &result(int index) const { return results_[index]; }
+
+    protected:
+
+        /**
+          * @brief  构造事件数组
+          * @param  事件数组的初始长度
+          */
+        explicit Poller(int init_size) : events_(init_size) {}
+
+        // 就绪事件数组
+        std::vector<struct epoll_event> events_;
+        // 与事件数组按下标对应的完成结果，只由以完成模型工作的后端使用
+        std::vector<Result> results_;
+
+    };
+
+}
@@ -10,9 +10,10 @@ namespace CwNetWork {
 
         /**
           * @brief  构造一个用于连接服务端的Socket对象
+          * @param  _1:地址族，如AF_INET、AF_INET6、AF_UNIX _2:套接字类型，如SOCK_STREAM、SOCK_SEQPACKET
           * @retval Socket对象
           */
-        static Socket newSocket();
+        static Socket newSocket(int family = AF_INET, int type = SOCK_STREAM);
 
         /**
           * @brief  根据提供的套接字描述符创建Socket对象
@@ -33,6 +34,76 @@ namespace CwNetWork {
           */
         void setNonBlock() const;
 
+        /**
+          * @brief  开启或关闭TCP_NODELAY，开启后小数据立即发送而不等待Nagle算法合并
+          * @param  是否开启
+          * @retval 是否设置成功
+          */
+        bool setNoDelay(bool) const;
+
+        /**
+          * @brief  设置发送缓冲区大小SO_SNDBUF
+          * @note   内核实际使用的大小为设置值的两倍
+          * @param  字节数
+          * @retval 是否设置成功
+          */
+        bool setSendBuffer(int) const;
+
+        /**
+          * @brief  设置接收缓冲区大小SO_RCVBUF
+          * @note   窗口扩大因子在握手时确定，需在连接建立前设置才能通告更大的窗口
+          * @param  字节数
+          * @retval 是否设置成功
+          */
+        bool setRecvBuffer(int) const;
+
+        /**
+          * @brief  开启TCP_FASTOPEN_CONNECT，随后的connect在有缓存的Cookie时将首次发送的数据携带在SYN中
+          * @note   必须在connect之前设置，需Linux 4.11及以上
+          * @param  是否开启
+          * @retval 是否设置成功
+          */
+        bool setFastOpenConnect(bool) const;
+
+        /**
+          * @brief  设置TCP_NOTSENT_LOWAT，发送缓冲区中未发送的数据低于该值时才报告可写
+          * @note   可避免大量数据堆积在内核中，降低后写入数据的排队延迟
+          * @param  字节数
+          * @retval 是否设置成功
+          */
+        bool setNotSentLowat(int) const;
+
+        /**
+          * @brief  开启或关闭TCP_QUICKACK，开启后立即回复ACK而不延迟
+          * @note   该选项不是持久的，内核可能在之后的收发中自行退出快速ACK模式
+          * @param  是否开启
+          * @retval 是否设置成功
+          */
+        bool setQuickAck(bool) const;
+
+        /**
+          * @brief  设置SO_BUSY_POLL，阻塞接收时在该时长内忙轮询网卡队列
+          * @note   以CPU换取更低的接收延迟，大于系统net.core.busy_read时需CAP_NET_ADMIN
+          * @param  微秒数，0表示关闭
+          * @retval 是否设置成功
+          */
+        bool setBusyPoll(int) const;
+
+        /**
+          * @brief  设置SO_LINGER
+          * @note   开启且超时为0时关闭套接字会丢弃未发送的数据并发送RST，不进入TIME_WAIT
+          * @param  _1:是否开启 _2:关闭时等待未发送数据的秒数
+          * @retval 是否设置成功
+          */
+        bool setLinger(bool, int) const;
+
+        /**
+          * @brief  设置TCP_USER_TIMEOUT，已发送数据超过该时长仍未被确认时内核断开连接
+          * @param  毫秒数，0表示使用系统默认值
+          * @retval 是否设置成功
+          */
+        bool setUserTimeout(unsigned int) const;
+
         /**
           * @brief  获取该套接字描述符
           * @retval 套接字描述符
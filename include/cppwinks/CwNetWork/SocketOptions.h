@@ -0,0 +1,137 @@
+#pragma once
+
+#include "ServerSocket.h"
+#include <string>
+
+namespace CwNetWork {
+
+    /*
+     * 一组可选的套接字调优选项，只有设置过的选项才会被应用
+     * 服务端选项(TCP_DEFER_ACCEPT、TCP_FASTOPEN和收发缓冲区大小)作用于服务端套接字，由accept得到的套接字继承；
+     * 其余选项作用于每个已连接的套接字，TCP_FASTOPEN_CONNECT只作用于主动连接的客户端套接字
+     */
+    class SocketOptions {
+
+    public:
+
+        /**
+          * @brief  开启或关闭TCP_NODELAY
+          * @param  是否开启
+          */
+        void setNoDelay(bool on) { no_delay_ = on; }
+
+        /**
+          * @brief  设置发送缓冲区大小SO_SNDBUF
+          * @param  字节数
+          */
+        void setSendBuffer(int bytes) { send_buffer_ = bytes; }
+
+        /**
+          * @brief  设置接收缓冲区大小SO_RCVBUF
+          * @param  字节数
+          */
+        void setRecvBuffer(int bytes) { recv_buffer_ = bytes; }
+
+        /**
+          * @brief  设置服务端TCP_DEFER_ACCEPT
+          * @param  等待首个数据的秒数，0表示关闭
+          */
+        void setDeferAccept(int seconds) { defer_accept_ = seconds; }
+
+        /**
+          * @brief  设置服务端TCP_FASTOPEN
+          * @param  尚未完成握手的Fast Open连接队列长度，0表示关闭
+          */
+        void setFastOpen(int queue_len) { fast_open_ = queue_len; }
+
+        /**
+          * @brief  开启或关闭客户端TCP_FASTOPEN_CONNECT
+          * @param  是否开启
+          */
+        void setFastOpenConnect(bool on) { fast_open_connect_ = on; }
+
+        /**
+          * @brief  设置TCP_NOTSENT_LOWAT
+          * @param  字节数
+          */
+        void setNotSentLowat(int bytes) { notsent_lowat_ = bytes; }
+
+        /**
+          * @brief  开启或关闭TCP_QUICKACK
+          * @note   只在连接建立时设置一次，内核可能在之后的收发中自行退出快速ACK模式
+          * @param  是否开启
+          */
+        void setQuickAck(bool on) { quick_ack_ = on; }
+
+        /**
+          * @brief  设置SO_BUSY_POLL
+          * @param  微秒数，0表示关闭
+          */
+        void setBusyPoll(int usec) { busy_poll_ = usec; }
+
+        /**
+          * @brief  设置SO_LINGER
+          * @param  _1:是否开启 _2:关闭时等待未发送数据的秒数
+          */
+        void setLinger(bool on, int seconds) {
+            linger_ = on ? 1 : 0;
+            linger_seconds_ = seconds;
+        }
+
+        /**
+          * @brief  设置TCP_USER_TIMEOUT
+          * @param  毫秒数，0表示使用系统默认值
+          */
+        void setUserTimeout(unsigned int ms) { user_timeout_ = static_cast<long>(ms); }
+
+        /**
+          * @brief  将服务端选项应用于服务端套接字
+          * @note   应在serverListen之前调用
+          * @param  _1:服务端套接字 _2:失败时写入失败的选项
+          * @retval 是否全部设置成功
+          */
+        bool applyTo(const ServerSocket &, std::string &) const;
+
+        /**
+          * @brief  将连接选项应用于由accept得到的套接字
+          * @param  _1:套接字 _2:失败时写入失败的选项
+          * @retval 是否全部设置成功
+          */
+        bool applyToAccepted(const Socket &, std::string &) const;
+
+        /**
+          * @brief  将连接选项和客户端选项应用于将要主动连接的套接字
+          * @note   应在connect之前调用，收发缓冲区大小也在此设置
+          * @param  _1:套接字 _2:失败时写入失败的选项
+          * @retval 是否全部设置成功
+          */
+        bool applyToClient(const Socket &, std::string &) const;
+
+        /**
+          * @brief  是否设置过任何作用于已连接套接字的选项
+          * @retval bool
+          */
+        bool hasConnectionOptions() const {
+            return no_delay_ != -1 || notsent_lowat_ != -1 || quick_ack_ != -1 || busy_poll_ != -1 ||
+                   linger_ != -1 || user_timeout_ != -1;
+        }
+
+    private:
+
+        // 以下选项为-1表示未设置
+        int no_delay_ = -1;
+        int send_buffer_ = -1;
+        int recv_buffer_ = -1;
+        int defer_accept_ = -1;
+        int fast_open_ = -1;
+        int fast_open_connect_ = -1;
+        int notsent_lowat_ = -1;
+        int quick_ack_ = -1;
+        int busy_poll_ = -1;
+        int linger_ = -1;
+        int linger_seconds_ = 0;
+        long user_timeout_ = -1;
+
+    };
+
+}
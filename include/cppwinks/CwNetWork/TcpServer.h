@@ -1,13 +1,47 @@
 #pragma once
 
 #include "ServerSocket.h"
-#include "Epoll.h"
+#include "SocketOptions.h"
+#include "EventLoop.h"
+#include "Codec.h"
+#include "BufferPool.h"
 #include <unordered_map>
 #include <functional>
 #include <utility>
+#include <memory>
+#include <vector>
+#include <atomic>
+#include <mutex>
 
 namespace CwNetWork {
 
+    /*
+     * REUSE_PORT: 每个事件循环拥有开启SO_REUSEPORT的服务端套接字，由内核分发新连接
+     * ACCEPTOR: 由独立的接受连接事件循环accept4新连接，再通过eventfd移交给工作事件循环
+     */
+    enum class AcceptMode {
+        REUSE_PORT, ACCEPTOR
+    };
+
+    /*
+     * 接受连接的统计
+     * accepted: 已接受的连接数  rejected: 接受后因文件描述符耗尽等原因立即关闭的连接数
+     * deferred: 因连接数或接受速率达到上限而暂停接受、让新连接留在内核等待队列中的次数
+     */
+    struct AdmissionStats {
+        uint64_t accepted = 0;
+        uint64_t rejected = 0;
+        uint64_t deferred = 0;
+    };
+
+    /*
+     * ACCEPTOR模式下选择工作事件循环的策略
+     * ROUND_ROBIN: 轮询  LEAST_LOADED: 选择当前连接数最少的事件循环
+     */
+    enum class DispatchPolicy {
+        ROUND_ROBIN, LEAST_LOADED
+    };
+
     class TcpServer {
 
     public:
@@ -19,18 +53,66 @@ namespace CwNetWork {
          */
         using RecvCallBack = std::function<void(Socket, const std::string &, TcpServer *const)>;
 
+        /*
+         * 回调函数第一个参数为当前消息发送的Socket对象
+         * 回调函数第二、三个参数为消息内容的起始地址和长度，仅在回调执行期间有效
+         * 回调函数第四个参数为服务端对象的指针常量
+         */
+        using MessageCallBack = std::function<void(Socket, const char *, size_t, TcpServer *const)>;
+
         /*
          * 回调函数要求返回一个已经建立好连接的客户端Socket对象
          * 回调函数参数为服务端ServerSocket对象
          */
         using AcceptCallBack = std::function<Socket(const ServerSocket &)>;
 
+        /*
+         * 回调函数第一个参数为新建立连接的客户端对象
+         * 回调函数第二个参数为服务端对象的指针常量
+         */
+        using ConnectCallBack = std::function<void(const Socket &, TcpServer *const)>;
+
         /*
          * 回调函数第一个参数为即将断开连接的客户端对象
          * 回调函数第二个参数为服务端对象的指针常量
          */
         using CloseCallBack = std::function<void(const Socket &, TcpServer *const)>;
 
+        /*
+         * 回调函数第一个参数为空闲超时的客户端对象
+         * 回调函数第二个参数为服务端对象的指针常量
+         */
+        using IdleCallBack = std::function<void(const Socket &, TcpServer *const)>;
+
+        /*
+         * 回调函数第一个参数为发送缓冲区越过水位的客户端对象
+         * 回调函数第二个参数为当前待发送的字节数
+         * 回调函数第三个参数为服务端对象的指针常量
+         */
+        using WaterMarkCallBack = std::function<void(const Socket &, size_t, TcpServer *const)>;
+
+        /*
+         * 热升级时保存连接状态的回调，在旧进程中连接所属的事件循环线程中执行
+         * 回调函数第一个参数为要移交的客户端对象，第二个参数为服务端对象的指针常量
+         * 返回值为该连接的状态，原样交给新进程的恢复回调
+         */
+        using UpgradeSaveCallBack = std::function<std::string(const Socket &, TcpServer *const)>;
+
+        /*
+         * 热升级时恢复连接状态的回调，在新进程调用run的线程中、事件循环启动前执行
+         * 回调函数第一个参数为接管的客户端对象，第二个参数为旧进程保存的状态，第三个参数为服务端对象的指针常量
+         */
+        using UpgradeRestoreCallBack = std::function<void(const Socket &, const std::string &, TcpServer *const)>;
+
+        /*
+         * 广播筛选条件，参数为候选的客户端对象，返回是否发送给该客户端
+         * 在各连接所属的事件循环线程中并发调用
+         */
+        using BroadcastFilter = std::function<bool(const Socket &)>;
+
+        // 投递到事件循环线程中执行的任务
+        using Functor = EventLoop::Functor;
+
         /**
           * @brief  按默认参数构造一个Tcp服务端
           */
@@ -62,6 +144,123 @@ namespace CwNetWork {
           */
         void setRecvCallBack(RecvCallBack recv_callback) { recv_cb_ = std::move(recv_callback); }
 
+        /**
+          * @brief  设置不复制数据的接收消息回调函数
+          * @note   设置后将代替接收数据回调函数，消息内容直接指向连接的接收缓冲区
+          * @param  MessageCallBack => void(Socket, const char *, size_t, TcpServer *const)
+          */
+        void setMessageCallBack(MessageCallBack message_callback) { message_cb_ = std::move(message_callback); }
+
+        /**
+          * @brief  设置消息分帧编解码器
+          * @note   设置后每次回调只交付一条完整消息，一次读取中的多条消息将依次回调；
+          *         未设置时回调交付本次读取到的全部数据。必须在run之前设置
+          * @param  编解码器，可被多个服务端共享
+          */
+        void setCodec(std::shared_ptr<Codec> codec) { codec_ = std::move(codec); }
+
+        /**
+          * @brief  设置连接空闲超时
+          * @note   连接超过指定时间未收到任何数据时，在其所属事件循环线程中执行空闲回调，之后重新开始计时；
+          *         未设置空闲回调时直接断开连接(执行关闭回调)。超时由各事件循环内timerfd驱动的分层时间轮管理，
+          *         收到数据时刷新超时为O(1)操作，精度为超时时间的1%(10毫秒至1秒)。必须在run之前设置
+          * @param  _1:空闲超时毫秒数，不大于0表示关闭 _2:IdleCallBack => void(const Socket &, TcpServer *const)
+          */
+        void setIdleTimeout(int timeout_ms, IdleCallBack idle_callback = nullptr) {
+            idle_timeout_ms_ = timeout_ms;
+            idle_cb_ = std::move(idle_callback);
+        }
+
+        /**
+          * @brief  设置每个连接发送缓冲区的高低水位
+          * @note   待发送数据增长到不低于高水位时执行高水位回调，此后回落到不高于低水位时执行低水位回调，
+          *         两者在连接所属事件循环线程中成对出现；回调中可以调用disConnect断开慢速的对端。必须在run之前设置
+          * @param  _1:高水位字节数，0表示关闭 _2:低水位字节数，应小于高水位
+          *         _3:高水位回调 _4:低水位回调 => void(const Socket &, size_t, TcpServer *const)
+          */
+        void setWaterMarks(size_t high_water_mark, size_t low_water_mark, WaterMarkCallBack high_water_callback = nullptr,
+                           WaterMarkCallBack low_water_callback = nullptr) {
+            high_water_mark_ = high_water_mark;
+            low_water_mark_ = low_water_mark;
+            high_water_cb_ = std::move(high_water_callback);
+            low_water_cb_ = std::move(low_water_callback);
+        }
+
+        /**
+          * @brief  设置发送缓冲区越过高水位期间是否暂停读取该连接
+          * @note   暂停期间不再关心可读事件，对端的请求留在内核接收队列中，由TCP流量控制让对端减速；
+          *         回落到低水位后恢复读取。需同时通过setWaterMarks设置高水位，必须在run之前设置
+          * @param  是否暂停读取
+          */
+        void setPauseReading(bool pause_reading) { pause_reading_ = pause_reading; }
+
+        /**
+          * @brief  设置写停滞超时
+          * @note   连接有待发送数据且超过指定时间没有任何数据被对端接收时直接断开连接(执行关闭回调)，
+          *         与空闲超时共用事件循环内的时间轮。必须在run之前设置
+          * @param  写停滞超时毫秒数，不大于0表示关闭
+          */
+        void setWriteStallTimeout(int timeout_ms) { write_stall_timeout_ms_ = timeout_ms; }
+
+        /**
+          * @brief  设置最大连接数
+          * @note   连接数达到上限时将服务端套接字从Poller上移除，新连接留在内核的等待队列(长度为backlog)中，
+          *         有连接关闭后恢复接受。多个事件循环同时接受时可能短暂超出上限。必须在run之前设置
+          * @param  最大连接数，0表示不限制
+          */
+        void setMaxConnections(size_t max_connections) { max_connections_ = max_connections; }
+
+        /**
+          * @brief  设置接受连接的速率
+          * @note   以令牌桶限制每秒接受的连接数，令牌不足时暂停接受直到补充出一个令牌，突发的连接由内核等待队列吸收；
+          *         REUSE_PORT模式下速率和容量由各事件循环均分。必须在run之前设置
+          * @param  _1:每秒接受的连接数，不大于0表示不限制 _2:令牌桶容量即允许的突发连接数，0表示与速率相同
+          */
+        void setAcceptRate(double per_second, size_t burst = 0) {
+            accept_rate_ = per_second;
+            accept_burst_ = burst > 0 ? static_cast<double>(burst) : per_second;
+        }
+
+        /**
+          * @brief  获取接受连接的统计
+          * @note   线程安全
+          * @retval AdmissionStats
+          */
+        AdmissionStats getAdmissionStats() const {
+            AdmissionStats stats;
+            stats.accepted = accepted_count_.load(std::memory_order_relaxed);
+            stats.rejected = rejected_count_.load(std::memory_order_relaxed);
+            stats.deferred = deferred_count_.load(std::memory_order_relaxed);
+            return stats;
+        }
+
+        /**
+          * @brief  获取当前的连接数(含已接受但尚未注册到事件循环的连接)
+          * @note   线程安全；服务端未运行时为0
+          * @retval 连接数
+          */
+        size_t getConnectionCount() const;
+
+        /**
+          * @brief  设置套接字调优选项
+          * @note   服务端选项在监听前应用于服务端套接字，连接选项应用于每个新接受的连接；
+          *         run时先在一个临时套接字上试设连接选项，不被支持或权限不足时run失败。热升级继承的套接字保持原有选项。
+          *         必须在run之前设置
+          * @param  SocketOptions
+          */
+        void setSocketOptions(const SocketOptions &options) { socket_options_ = options; }
+
+        /**
+          * @brief  设置零拷贝发送阈值
+          * @note   待发送数据中不小于该长度的数据块以MSG_ZEROCOPY发送，内核直接引用数据块的内存，
+          *         直到错误队列中的完成通知到达才释放。小于约10KB的数据块零拷贝的页锁定开销通常高于复制；
+          *         回环等内核回退为复制的连接会自动关闭零拷贝。有未完成的零拷贝发送时断开连接会以RST关闭。
+          *         需内核支持SO_ZEROCOPY，不支持时静默退回普通发送；IO_URING后端以发送请求写出的数据不使用零拷贝。
+          *         必须在run之前设置
+          * @param  阈值字节数，0表示关闭
+          */
+        void setZeroCopyThreshold(size_t threshold) { zerocopy_threshold_ = threshold; }
+
         /**
           * @brief  设置接受连接回调函数
           * @note   该回调结束后会自动将客户端Socket设置为非阻塞
@@ -69,6 +268,14 @@ namespace CwNetWork {
           */
         void setAcceptCallBack(AcceptCallBack accept_callback) { accept_cb_ = std::move(accept_callback); }
 
+        /**
+          * @brief  设置连接建立的回调函数
+          * @note   在连接注册到所属事件循环后于该事件循环线程中执行，可以在回调中发送数据、设置连接上下文或断开连接；
+          *         热升级接管的连接不执行该回调，由升级恢复回调负责
+          * @param  ConnectCallBack => void(const Socket &, TcpServer *const)
+          */
+        void setConnectCallBack(ConnectCallBack connect_callback) { connect_cb_ = std::move(connect_callback); }
+
         /**
           * @brief  设置即将断开连接的回调函数
           * @note   该回调执行时socket还未完成连接的断开，请勿手动操作断开或向缓冲区写入数据
@@ -83,14 +290,100 @@ namespace CwNetWork {
         void setBackLogSize(int backlog) { backlog_ = backlog; }
 
         /**
-          * @brief  设置接收缓冲区最大长度
-          * @param  接收缓冲区最大长度
+          * @brief  设置监听地址和套接字类型，替代构造时指定的端口
+          * @note   支持IPv4、IPv6和Unix域套接字地址。Unix域套接字不支持SO_REUSEPORT分发连接，
+          *         多个事件循环时自动改为ACCEPTOR模式；服务端停止时删除套接字文件，热升级移交后保留。
+          *         SOCK_SEQPACKET时每条记录单独交给接收数据回调(设置了编解码器时仍按字节流解码)，
+          *         长于接收缓冲区容量加64KB的记录会被截断；每次sendAll的数据作为一条记录发送，不支持sendFile和sendPipe。
+          *         必须在run之前设置
+          * @param  _1:监听地址 _2:套接字类型，SOCK_STREAM或SOCK_SEQPACKET(仅Unix域套接字)
+          */
+        void setListenAddress(const AddrInfo &addr, int type = SOCK_STREAM) {
+            listen_addr_ = addr;
+            socket_type_ = type;
+        }
+
+        /**
+          * @brief  获取监听地址
+          * @retval AddrInfo
+          */
+        const AddrInfo &getListenAddress() const { return listen_addr_; }
+
+        /**
+          * @brief  设置每个连接接收缓冲区的初始容量
+          * @note   连接首次可读时分配，数据更多时自动扩容
+          * @param  接收缓冲区初始容量
           */
         void setRbufSize(size_t rbuf_size) { rbuf_size_ = rbuf_size; }
 
+        /**
+          * @brief  设置连接接收缓冲区借用的内存块池，默认启用
+          * @note   块大小为接收缓冲区初始容量加头部预留空间，由全部事件循环共享。连接可读时借用一个块，
+          *         数据全部交给回调后立即归还，空闲连接不持有接收缓冲区；半个帧等未交付的数据一直占用到交付为止。
+          *         超出块大小的数据改为堆上分配，交付后同样释放。不启用时首次可读时分配的初始容量一直保留到断开，
+          *         只有扩容部分在交付后释放。必须在run之前设置
+          * @param  _1:是否启用 _2:最多切出的块数，0表示不限制，耗尽后退回堆上分配 _3:是否尝试以MAP_HUGETLB大页映射
+          */
+        void setBufferPool(bool enable, size_t max_blocks = 0, bool huge_pages = false) {
+            buffer_pool_enabled_ = enable;
+            buffer_pool_max_blocks_ = max_blocks;
+            buffer_pool_huge_pages_ = huge_pages;
+        }
+
+        /**
+          * @brief  获取连接接收缓冲区借用的内存块池，可用于查询块的使用情况
+          * @retval BufferPool指针，未启用或服务端尚未运行时为空
+          */
+        const BufferPool *getBufferPool() const { return buffer_pool_.get(); }
+
+        /**
+          * @brief  设置事件循环(Reactor)线程数量
+          * @note   大于1时每个事件循环独占一个线程、一个Poller和一个开启SO_REUSEPORT的服务端套接字，
+          *         由内核在各事件循环间分发新连接；回调函数将在连接所属的事件循环线程中并发执行
+          * @param  事件循环数量，必须在run之前设置
+          */
+        void setLoopNum(size_t loop_num) { loop_num_ = loop_num > 0 ? loop_num : 1; }
+
+        /**
+          * @brief  设置新连接的接受模式
+          * @note   ACCEPTOR模式下调用run的线程只负责接受连接，另开setLoopNum个线程处理连接上的IO
+          * @param  AcceptMode，必须在run之前设置
+          */
+        void setAcceptMode(AcceptMode accept_mode) { accept_mode_ = accept_mode; }
+
+        /**
+          * @brief  设置ACCEPTOR模式下分发新连接的策略
+          * @param  DispatchPolicy，必须在run之前设置
+          */
+        void setDispatchPolicy(DispatchPolicy policy) { dispatch_policy_ = policy; }
+
+        /**
+          * @brief  设置事件循环使用的IO多路复用后端
+          * @note   默认为EPOLL_ET；内核不支持所选后端时run将初始化失败并返回。IO_URING后端在内核支持时
+          *         使用默认接受回调的服务端套接字以accept请求接受连接，流式连接以recv和发送请求收发数据
+          * @param  IoBackend，必须在run之前设置
+          */
+        void setIoBackend(IoBackend backend) { io_backend_ = backend; }
+
+        /**
+          * @brief  开启热升级
+          * @note   run时先连接指定路径：有旧进程在监听时，接管它的服务端套接字和全部连接(含接收缓冲区中的半帧、
+          *         发送缓冲区中尚未发送的数据和使用者保存的状态)，旧进程随后不执行关闭回调直接退出；没有旧进程时正常启动。
+          *         启动后在该路径上监听下一次升级。移交期间投递给已导出连接的待发送数据会丢失；
+          *         新进程应使用相同的事件循环数和接受连接模式，多出的继承服务端套接字会被关闭。必须在run之前设置
+          * @param  _1:Unix域套接字路径 _2:保存连接状态的回调 _3:恢复连接状态的回调
+          */
+        void setUpgrade(const std::string &path, UpgradeSaveCallBack save_callback = nullptr,
+                        UpgradeRestoreCallBack restore_callback = nullptr) {
+            upgrade_path_ = path;
+            upgrade_save_cb_ = std::move(save_callback);
+            upgrade_restore_cb_ = std::move(restore_callback);
+        }
+
         /**
           * @brief  向指定的套接字描述符发送数据
-          * @note   如果对端不可写，该方法将会异步等待epoll调用
+          * @note   如果对端不可写，该方法将会异步等待epoll调用；
+          *         线程安全，在其他线程中调用时数据将被复制并投递到连接所属的事件循环中发送
           * @param  指定的套接字描述符、要发送的数据
           */
         void sendAll(int, const std::string &);
@@ -102,9 +395,134 @@ namespace CwNetWork {
           */
         void sendAll(Socket client, const std::string &message) { sendAll(client.getFd(), message); }
 
+        /**
+          * @brief  将文件的指定区间发送给指定的套接字描述符，数据由sendfile在内核中直接从页缓存写入套接字
+          * @note   与sendAll共用同一个发送队列并保持先后顺序；文件描述符在调用时被复制，调用返回后即可关闭；
+          *         发送期间文件被截断时丢弃剩余部分。如果指定的套接字描述符不属于任何事件循环，
+          *         会抛出std::out_of_range异常；线程安全
+          * @param  _1:指定的套接字描述符 _2:文件描述符 _3:区间起始偏移 _4:区间长度，0表示到文件末尾
+          * @retval 是否成功加入发送队列，复制文件描述符或获取文件大小失败时返回false
+          */
+        bool sendFile(int, int, off_t, size_t);
+
+        /**
+          * @brief  将管道中的指定字节数发送给指定的套接字描述符，数据由splice在内核中直接移入套接字
+          * @note   与sendAll共用同一个发送队列并保持先后顺序；管道读端描述符在调用时被复制，调用返回后即可关闭。
+          *         轮到该段发送时管道中应已有数据(如由vmsplice、tee或其他进程写入)，写端关闭导致数据不足时丢弃剩余部分；
+          *         管道暂时为空时该连接的发送将停滞，由写停滞超时兜底。线程安全
+          * @param  _1:指定的套接字描述符 _2:管道读端描述符 _3:字节数
+          * @retval 是否成功加入发送队列，复制描述符失败时返回false
+          */
+        bool sendPipe(int, int, size_t);
+
+        /**
+          * @brief  向满足条件的全部客户端发送同一份数据
+          * @note   数据只复制一次，全部连接的发送队列共享同一个只读数据块，最后一个连接发送完毕后释放；
+          *         每个事件循环只投递一个任务，在各自的线程中筛选并发送。服务端未运行时忽略；线程安全
+          * @param  _1:要发送的数据 _2:筛选条件，为空时发送给全部客户端
+          */
+        void broadcast(const std::string &, BroadcastFilter filter = nullptr);
+
+        /**
+          * @brief  向指定的一批套接字描述符发送同一份数据
+          * @note   数据只复制一次并在全部连接间共享；描述符按所属事件循环分组，每个事件循环只投递一个任务。
+          *         不属于任何事件循环的描述符被忽略。服务端未运行时忽略；线程安全
+          * @param  _1:要发送的数据 _2:套接字描述符集合
+          */
+        void broadcast(const std::string &, const std::vector<int> &);
+
+        /**
+          * @brief  获取连接的会话标识，用于在其他通道(如UdpServer)上识别该连接
+          * @note   会话标识由文件描述符和每个连接随机生成的32位数组成，连接关闭后失效，不会与复用同一描述符的新连接混淆；
+          *         热升级后描述符和随机数都会改变，客户端需重新获取。如果该文件描述符不属于任何事件循环，会抛出std::out_of_range异常；线程安全
+          * @param  客户端Socket
+          * @retval 会话标识
+          */
+        uint64_t getSessionId(const Socket &) const;
+
+        /**
+          * @brief  判断会话标识对应的连接是否仍然存在
+          * @note   线程安全
+          * @param  会话标识
+          * @retval 连接是否存在
+          */
+        bool isSessionAlive(uint64_t session) const {
+            EventLoop *loop = nullptr;
+            uint32_t generation = 0;
+            return findSession(session, loop, generation) != nullptr;
+        }
+
+        /**
+          * @brief  刷新一批会话对应连接的空闲计时，相当于这些连接刚收到数据
+          * @note   会话按所属事件循环分组，每个事件循环只投递一个任务；失效的会话被忽略。线程安全
+          * @param  会话标识集合
+          * @retval 有效的会话数
+          */
+        size_t touchSessions(const std::vector<uint64_t> &);
+
+        /**
+          * @brief  在指定毫秒数后于主事件循环线程中执行任务
+          * @note   线程安全，从调用时刻开始计时；run之前调用时加入的定时器在run启动后生效，服务端停止时未到期的定时器被丢弃。
+          *         周期性工作无需额外的线程和锁，访问连接应使用线程安全的接口
+          * @param  _1:延迟毫秒数 _2:要执行的任务
+          * @retval 定时器句柄，可在任意线程中取消
+          */
+        TimerId runAfter(int delay_ms, Functor cb) { return addTimer(TimerQueue::newTimer(delay_ms, 0, std::move(cb))); }
+
+        /**
+          * @brief  每隔指定毫秒数于主事件循环线程中执行一次任务，直到取消或服务端停止
+          * @note   线程安全，首次在一个周期后执行；任务耗时超过周期时不补执行错过的次数
+          * @param  _1:周期毫秒数，不小于1 _2:要执行的任务
+          * @retval 定时器句柄，可在任意线程中取消
+          */
+        TimerId runEvery(int interval_ms, Functor cb) {
+            interval_ms = interval_ms > 0 ? interval_ms : 1;
+            return addTimer(TimerQueue::newTimer(interval_ms, interval_ms, std::move(cb)));
+        }
+
+        /**
+          * @brief  取消runAfter或runEvery加入的定时器
+          * @note   线程安全，等同于TimerId::cancel
+          * @param  定时器句柄
+          */
+        void cancel(const TimerId &timer_id) { timer_id.cancel(); }
+
+        /**
+          * @brief  设置连接的上下文，连接断开时自动释放
+          * @note   只能在连接所属的事件循环线程中(如各回调函数中)调用，否则会抛出std::out_of_range异常；
+          *         上下文在关闭回调执行之后释放，用于保存协议状态而无需自行维护以描述符为键的全局表
+          * @param  _1:客户端Socket _2:上下文
+          */
+        void setContext(const Socket &, std::shared_ptr<void>);
+
+        /**
+          * @brief  获取连接的上下文
+          * @note   只能在连接所属的事件循环线程中调用，否则会抛出std::out_of_range异常
+          * @param  客户端Socket
+          * @retval 上下文，未设置时为空
+          */
+        const std::shared_ptr<void> &getContext(const Socket &) const;
+
+        /**
+          * @brief  使用编解码器将消息编码为一帧后发送给指定的套接字描述符
+          * @note   未设置编解码器时等同于sendAll；消息无法编码为一帧时(如超出长度字段的表示范围)抛出编解码器的异常，
+          *         不发送任何数据；线程安全
+          * @param  指定的套接字描述符、要发送的消息
+          */
+        void sendFrame(int fd, const std::string &message) {
+            sendAll(fd, codec_ != nullptr ? codec_->encode(message) : message);
+        }
+
+        /**
+          * @brief  使用编解码器将消息编码为一帧后发送给指定的Socket对象
+          * @param  指定的Socket对象、要发送的消息
+          */
+        void sendFrame(Socket client, const std::string &message) { sendFrame(client.getFd(), message); }
+
         /**
           * @brief  根据指定的客户端文件描述符断开连接
-          * @note   该函数将管理要断开的文件描述符的全部生命周期
+          * @note   该函数将管理要断开的文件描述符的全部生命周期；
+          *         线程安全，在其他线程中调用时将投递到连接所属的事件循环中断开
           * @param  指定的客户端文件描述符
           */
         void disConnect(int);
@@ -116,6 +534,21 @@ namespace CwNetWork {
           */
         void disConnect(const Socket &client) { disConnect(client.getFd()); }
 
+        /**
+          * @brief  在主事件循环线程中执行任务
+          * @note   线程安全，主事件循环为REUSE_PORT模式下运行于调用run线程的事件循环、ACCEPTOR模式下的第一个工作事件循环；
+          *         如果服务端尚未运行，会抛出std::runtime_error异常
+          * @param  要执行的任务
+          */
+        void runInLoop(Functor cb) { baseLoop()->runInLoop(std::move(cb)); }
+
+        /**
+          * @brief  将任务投递到主事件循环的任务队列
+          * @note   线程安全，如果服务端尚未运行，会抛出std::runtime_error异常
+          * @param  要执行的任务
+          */
+        void queueInLoop(Functor cb) { baseLoop()->queueInLoop(std::move(cb)); }
+
         /**
           * @brief  获取服务端启动失败原因
           * @retval 服务端启动失败原因的描述
@@ -124,18 +557,39 @@ namespace CwNetWork {
 
         /**
           * @brief  获取已连接的客户端对象键值对
+          * @note   线程安全，各事件循环在自己的线程中收集后返回，调用方阻塞到全部事件循环处理完本轮事件；
+          *         在事件循环线程中调用时不要与其他事件循环线程同时调用，否则会彼此等待
           * @retval 已连接的客户端对象键值对
           */
-        std::unordered_map<int, Socket> getClients() const { return clients_; }
+        std::unordered_map<int, Socket> getClients() const;
 
         /**
           * @brief  启动Tcp服务端
-          * @note   该函数为阻塞函数
+          * @note   该函数为阻塞函数，调用stop或排空完成后返回；SIGPIPE仍为默认处理时将被忽略
           */
         virtual bool run();
 
+        /**
+          * @brief  停止Tcp服务端
+          * @note   通过eventfd唤醒全部事件循环，各事件循环处理完本轮事件后关闭剩余的连接(每个连接执行一次关闭回调)
+          *         并退出，run随后返回。不等待发送缓冲区写完；线程安全，可在信号处理函数中调用
+          */
+        void stop();
+
+        /**
+          * @brief  排空并停止Tcp服务端
+          * @note   立即停止接受新连接；发送缓冲区写完的连接以shutdown(SHUT_WR)半关闭，对端收到EOF后关闭连接时
+          *         按正常流程执行关闭回调。到达期限后仍未关闭的连接分批关闭，全部连接关闭后run返回。
+          *         排空期间仍会收到数据并执行回调，但写方向关闭后再发送的数据将被丢弃。
+          *         不阻塞；线程安全，可在信号处理函数中调用；重复调用时保留第一次设置的期限
+          * @param  排空期限毫秒数，不大于0表示立即关闭全部连接
+          */
+        void drain(int);
+
     private:
 
+        friend class EventLoop;
+
         /**
           * @brief  接受客户端连接的回调函数
           * @note   accept_cb_默认指向该函数，可被用户修改指向
@@ -151,28 +605,216 @@ namespace CwNetWork {
           */
         bool initServer();
 
+        /**
+          * @brief  连接热升级路径，有旧进程在监听时接收它移交的服务端套接字和连接
+          * @retval 没有旧进程或接收成功时返回true
+          */
+        bool takeOver();
+
+        /**
+          * @brief  取出一个从旧进程继承的服务端套接字
+          * @retval 服务端套接字描述符，没有时返回-1
+          */
+        int takeInheritedListener();
+
+        /**
+          * @brief  将继承的连接分配给各事件循环并执行恢复回调
+          */
+        void adoptInherited();
+
+        /**
+          * @brief  关闭尚未被使用的继承描述符
+          */
+        void releaseInherited();
+
+        // 热升级时各事件循环汇总导出内容的共享状态
+        struct Handover;
+
+        /**
+          * @brief  新进程请求热升级时让每个事件循环在各自的线程中导出连接
+          * @param  与新进程连接的Unix域套接字描述符
+          */
+        void handOver(int);
+
+        /**
+          * @brief  汇总一个事件循环导出的内容，最后一个事件循环负责发送，成功后停止全部事件循环，失败时恢复
+          * @param  _1:共享状态 _2:服务端套接字描述符 _3:连接集合
+          */
+        void collectHandover(Handover &, std::vector<int> &, std::vector<HandoffConnection> &);
+
+        /**
+          * @brief  连接关闭后通知因连接数达到上限而暂停的事件循环恢复接受
+          */
+        void resumeAccepting();
+
+        /**
+          * @brief  获取全部事件循环，含ACCEPTOR模式下的接受连接事件循环
+          * @retval 事件循环集合
+          */
+        std::vector<EventLoop *> allLoops() const;
+
+        /**
+          * @brief  从服务端套接字接受一个新连接并设置为非阻塞
+          * @note   使用默认接受连接回调时直接以accept4(SOCK_NONBLOCK | SOCK_CLOEXEC)接受
+          * @param  ServerSocket对象
+          * @retval 建立连接的Socket对象，失败时文件描述符为-1
+          */
+        Socket acceptClient(const ServerSocket &);
+
+        /**
+          * @brief  判断是否使用默认的接受连接回调
+          * @note   使用默认回调时事件循环可以由Poller直接接受连接
+          * @retval 是否为默认回调
+          */
+        bool defaultAccept() const;
+
+        /**
+          * @brief  为新连接选择所属的事件循环
+          * @param  接受该连接的事件循环
+          * @retval 负责该连接IO的事件循环
+          */
+        EventLoop *selectLoop(EventLoop *);
+
+        /**
+          * @brief  获取指定客户端文件描述符的连接及其所属的事件循环和槽位代数
+          * @note   线程安全；如果该文件描述符不属于任何事件循环，会抛出std::out_of_range异常
+          * @param  _1:客户端文件描述符 _2:所属的事件循环 _3:读取时的槽位代数
+          * @retval 连接槽指针
+          */
+        Connection *connectionOf(int, EventLoop *&, uint32_t &) const;
+
+        /**
+          * @brief  获取指定客户端文件描述符的连接及其所属的事件循环和槽位代数
+          * @note   线程安全；与connectionOf相同，但不属于任何事件循环时返回nullptr而不抛出异常
+          * @param  _1:客户端文件描述符 _2:所属的事件循环 _3:读取时的槽位代数
+          * @retval 连接槽指针，不存在时返回nullptr
+          */
+        Connection *findConnection(int, EventLoop *&, uint32_t &) const;
+
+        /**
+          * @brief  获取当前线程的事件循环管理的指定文件描述符的连接
+          * @note   如果该文件描述符不属于当前线程的事件循环，会抛出std::out_of_range异常
+          * @param  客户端套接字描述符
+          * @retval 连接槽指针
+          */
+        Connection *localConnection(int) const;
+
+        /**
+          * @brief  将定时器加入主事件循环，服务端未运行时暂存到run启动后加入
+          * @param  定时器
+          * @retval 定时器句柄
+          */
+        TimerId addTimer(std::shared_ptr<Timer>);
+
+        /**
+          * @brief  获取会话标识对应的连接及其所属的事件循环和槽位代数
+          * @note   线程安全
+          * @param  _1:会话标识 _2:所属的事件循环 _3:读取时的槽位代数
+          * @retval 连接槽指针，会话已失效时返回nullptr
+          */
+        Connection *findSession(uint64_t, EventLoop *&, uint32_t &) const;
+
+        /**
+          * @brief  获取主事件循环
+          * @note   如果服务端尚未运行，会抛出std::runtime_error异常
+          * @retval 主事件循环
+          */
+        EventLoop *baseLoop() const;
+
     private:
 
-        // 维护服务端套接字对象
-        ServerSocket server_socket_ = ServerSocket::newServerSocket();
-        // 服务端IO多路复用模型
-        Epoll epoll_;
-        // 维护已连接的客户端信息
-        std::unordered_map<int, Socket> clients_;
-        // 维护已连接的客户端端发送缓冲区
-        std::unordered_map<int, std::string> clients_sbuf_;
+        // 接收缓冲区借用的内存块池，须后于连接槽析构
+        std::unique_ptr<BufferPool> buffer_pool_;
+        // 以文件描述符为下标的连接槽，由全部事件循环共享，须先于事件循环构造、后于事件循环析构
+        std::unique_ptr<ConnectionSlab> slab_;
+        // 处理连接IO的事件循环集合，REUSE_PORT模式下下标0的事件循环运行于调用run的线程
+        std::vector<std::unique_ptr<EventLoop>> loops_;
+        // ACCEPTOR模式下只负责接受连接的事件循环，运行于调用run的线程
+        std::unique_ptr<EventLoop> acceptor_;
+        // 新连接的接受模式
+        AcceptMode accept_mode_ = AcceptMode::REUSE_PORT;
+        // ACCEPTOR模式下分发新连接的策略
+        DispatchPolicy dispatch_policy_ = DispatchPolicy::ROUND_ROBIN;
+        // 事件循环使用的IO多路复用后端
+        IoBackend io_backend_ = IoBackend::EPOLL_ET;
+        // 轮询分发的下一个事件循环下标
+        size_t next_loop_ = 0;
+        // 事件循环是否已全部初始化完成
+        std::atomic<bool> running_{false};
+        // 事件循环数量
+        size_t loop_num_ = 1;
         // 等待队列最大长度
         int backlog_ = 128;
-        // 服务器开启端口
-        unsigned short port_ = 8080;
-        // 接收缓冲区指针
-        char *rbuf_ = nullptr;
-        // 单次IO事件最大读出数据大小
+        // 监听地址
+        AddrInfo listen_addr_ = AddrInfo::anyAddress(8080);
+        // 服务端套接字类型
+        int socket_type_ = SOCK_STREAM;
+        // 连接接收缓冲区的初始容量
         size_t rbuf_size_ = 4096;
+        // 是否启用接收缓冲区内存块池
+        bool buffer_pool_enabled_ = true;
+        // 内存块池最多切出的块数，0表示不限制
+        size_t buffer_pool_max_blocks_ = 0;
+        // 内存块池是否尝试大页映射
+        bool buffer_pool_huge_pages_ = false;
         // 收到客户端数据时执行的回调函数
         RecvCallBack recv_cb_ = nullptr;
+        // 收到消息时执行的不复制数据的回调函数
+        MessageCallBack message_cb_ = nullptr;
+        // 消息分帧编解码器
+        std::shared_ptr<Codec> codec_;
         // 新的连接到来时执行的回调函数
         AcceptCallBack accept_cb_ = nullptr;
+        // 连接空闲超时毫秒数，不大于0表示关闭
+        int idle_timeout_ms_ = 0;
+        // 连接空闲超时时执行的回调函数
+        IdleCallBack idle_cb_ = nullptr;
+        // 发送缓冲区高水位字节数，0表示关闭
+        size_t high_water_mark_ = 0;
+        // 发送缓冲区低水位字节数
+        size_t low_water_mark_ = 0;
+        // 发送缓冲区越过高水位时执行的回调函数
+        WaterMarkCallBack high_water_cb_ = nullptr;
+        // 发送缓冲区回落到低水位时执行的回调函数
+        WaterMarkCallBack low_water_cb_ = nullptr;
+        // 越过高水位期间是否暂停读取
+        bool pause_reading_ = false;
+        // 写停滞超时毫秒数，不大于0表示关闭
+        int write_stall_timeout_ms_ = 0;
+        // 零拷贝发送阈值字节数，0表示关闭
+        size_t zerocopy_threshold_ = 0;
+        // 套接字调优选项
+        SocketOptions socket_options_;
+        // 最大连接数，0表示不限制
+        size_t max_connections_ = 0;
+        // 每秒接受的连接数，不大于0表示不限制
+        double accept_rate_ = 0;
+        // 接受连接令牌桶的容量
+        double accept_burst_ = 0;
+        // 已接受的连接数
+        std::atomic<uint64_t> accepted_count_{0};
+        // 接受后立即关闭的连接数
+        std::atomic<uint64_t> rejected_count_{0};
+        // 暂停接受的次数
+        std::atomic<uint64_t> deferred_count_{0};
+        // 当前暂停接受的事件循环数
+        std::atomic<int> paused_acceptors_{0};
+        // 热升级Unix域套接字路径，为空表示关闭
+        std::string upgrade_path_;
+        // 热升级时保存连接状态的回调函数
+        UpgradeSaveCallBack upgrade_save_cb_ = nullptr;
+        // 热升级时恢复连接状态的回调函数
+        UpgradeRestoreCallBack upgrade_restore_cb_ = nullptr;
+        // 从旧进程继承、尚未被事件循环使用的服务端套接字
+        std::vector<int> inherited_listeners_;
+        // 从旧进程继承、尚未分配给事件循环的连接
+        std::vector<HandoffConnection> inherited_conns_;
+        // 保护暂存的定时器
+        std::mutex timer_mutex_;
+        // run之前加入、在run启动后交给主事件循环的定时器
+        std::vector<std::shared_ptr<Timer>> pending_timers_;
+        // 连接建立后执行的回调函数
+        ConnectCallBack connect_cb_ = nullptr;
         // 客户端关闭连接后执行的回调函数
         CloseCallBack close_cb_ = nullptr;
         // 服务端异常日志
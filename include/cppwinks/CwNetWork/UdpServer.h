@@ -0,0 +1,186 @@
+#pragma once
+
+#include "SocketOptions.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+namespace CwNetWork {
+
+    class TcpServer;
+
+    /*
+     * 基于recvmmsg/sendmmsg批量收发的Udp服务端，适合心跳等大量短小的数据报
+     * 每个线程持有一个套接字(多个线程时开启SO_REUSEPORT由内核分发)，一次recvmmsg取回一批数据报并逐个交给回调，
+     * 回调中的回复和会话刷新先缓存，整批处理完后以一次sendmmsg发出、按事件循环分组一次性投递给TcpServer
+     */
+    class UdpServer {
+
+    public:
+
+        /*
+         * 收到数据报的回调函数，参数依次为对端地址、数据、数据长度和Udp服务端
+         * 在收到该数据报的线程中执行，多个线程时可能并发执行
+         */
+        using MessageCallBack = std::function<void(const AddrInfo &, const char *, size_t, UdpServer *const)>;
+
+        /**
+          * @brief  根据监听地址构造Udp服务端
+          * @param  _1:监听地址 _2:共享连接身份的Tcp服务端，为空时touch总是返回false
+          */
+        explicit UdpServer(const AddrInfo &, TcpServer *tcp_server = nullptr);
+
+        /**
+          * @brief  根据端口构造监听IPv4通配地址的Udp服务端
+          * @param  _1:端口 _2:共享连接身份的Tcp服务端
+          */
+        explicit UdpServer(unsigned short port, TcpServer *tcp_server = nullptr)
+                : UdpServer(AddrInfo::anyAddress(port), tcp_server) {}
+
+        ~UdpServer();
+
+        UdpServer(const UdpServer &) = delete;
+
+        UdpServer &operator=(const UdpServer &) = delete;
+
+        /**
+          * @brief  设置收到数据报的回调函数
+          * @param  MessageCallBack => void(const AddrInfo &, const char *, size_t, UdpServer *const)
+          */
+        void setMessageCallBack(MessageCallBack message_cb) { message_cb_ = std::move(message_cb); }
+
+        /**
+          * @brief  设置线程数量
+          * @note   大于1时每个线程持有一个开启SO_REUSEPORT的套接字；必须在run之前设置
+          * @param  线程数量
+          */
+        void setLoopNum(size_t loop_num) { loop_num_ = loop_num > 0 ? loop_num : 1; }
+
+        /**
+          * @brief  设置每次recvmmsg和sendmmsg处理的最大数据报数
+          * @note   内核限制单次最多kMaxBatchSize个；必须在run之前设置
+          * @param  数据报数
+          */
+        void setBatchSize(size_t batch_size);
+
+        /**
+          * @brief  设置接收数据报的最大长度
+          * @note   每个线程预先分配批大小乘以该长度的接收缓冲区，更长的数据报被截断并丢弃；必须在run之前设置
+          * @param  字节数
+          */
+        void setMaxDatagramSize(size_t max_size) { max_size_ = max_size > 0 ? max_size : 1; }
+
+        /**
+          * @brief  设置套接字选项，只应用收发缓冲区大小等作用于服务端套接字的选项
+          * @note   大量心跳时应增大接收缓冲区，避免批处理期间内核丢弃数据报；必须在run之前设置
+          * @param  SocketOptions
+          */
+        void setSocketOptions(const SocketOptions &options) { socket_options_ = options; }
+
+        /**
+          * @brief  运行Udp服务端，阻塞直到stop
+          * @note   如果失败可通过getError方法获取失败原因
+          * @retval 是否成功运行
+          */
+        bool run();
+
+        /**
+          * @brief  停止Udp服务端，run在各线程退出后返回
+          * @note   在run之前调用时下一次run立即返回；线程安全，可在信号处理函数中调用
+          */
+        void stop();
+
+        /**
+          * @brief  向指定地址发送一个数据报
+          * @note   在回调中调用时缓存到本批处理结束后以sendmmsg统一发送；其他线程中直接发送。
+          *         套接字发送缓冲区已满时数据报被丢弃；线程安全
+          * @param  _1:对端地址 _2:数据
+          * @retval 是否已发送或已缓存
+          */
+        bool sendTo(const AddrInfo &, const std::string &);
+
+        /**
+          * @brief  刷新会话对应的Tcp连接的空闲计时
+          * @note   在回调中调用时缓存到本批处理结束后统一投递；会话标识由TcpServer::getSessionId获得。线程安全
+          * @param  会话标识
+          * @retval 会话是否有效
+          */
+        bool touch(uint64_t);
+
+        /**
+          * @brief  获取共享连接身份的Tcp服务端
+          * @retval TcpServer指针，可能为空
+          */
+        TcpServer *getTcpServer() const { return tcp_server_; }
+
+        /**
+          * @brief  获取运行失败原因
+          * @retval 失败原因
+          */
+        const std::string &getError() const { return error_; }
+
+        // 单次recvmmsg和sendmmsg最多处理的数据报数(UIO_MAXIOV)
+        static const size_t kMaxBatchSize = 1024;
+
+    private:
+
+        struct Worker;
+
+        /**
+          * @brief  创建全部线程的套接字、唤醒描述符和Poller
+          * @retval 是否成功
+          */
+        bool initServer();
+
+        /**
+          * @brief  线程的事件循环
+          * @param  该线程的Worker
+          */
+        void loop(Worker &);
+
+        /**
+          * @brief  批量接收并处理数据报，直到套接字读空或达到本轮上限
+          * @param  Worker
+          */
+        void receive(Worker &);
+
+        /**
+          * @brief  以sendmmsg发送缓存的回复，并将缓存的会话刷新投递给Tcp服务端
+          * @param  Worker
+          */
+        void flush(Worker &);
+
+        /**
+          * @brief  获取当前线程所在的Worker
+          * @retval Worker指针，不在该服务端的线程中时返回nullptr
+          */
+        Worker *currentWorker() const;
+
+        // 监听地址
+        AddrInfo addr_;
+        // 共享连接身份的Tcp服务端
+        TcpServer *tcp_server_;
+        // 收到数据报的回调函数
+        MessageCallBack message_cb_;
+        // 线程数量
+        size_t loop_num_ = 1;
+        // 每批处理的最大数据报数
+        size_t batch_size_ = kMaxBatchSize;
+        // 接收数据报的最大长度
+        size_t max_size_ = 2048;
+        // 套接字选项
+        SocketOptions socket_options_;
+        // 各线程的状态
+        std::vector<std::unique_ptr<Worker>> workers_;
+        // 是否正在运行
+        std::atomic<bool> running_{false};
+        // 是否退出
+        std::atomic<bool> quit_{false};
+        // 运行失败原因
+        std::string error_;
+
+    };
+
+}
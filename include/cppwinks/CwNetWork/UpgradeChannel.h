@@ -0,0 +1,129 @@
+#pragma once
+
+#include "AddrInfo.h"
+#include <sys/types.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace CwNetWork {
+
+    /*
+     * 热升级时随连接一起移交的一段待发送数据
+     * 内存数据保存在data中；文件和管道段保存其描述符，发送后即由接收方接管
+     */
+    struct HandoffSegment {
+        // 内存数据，文件和管道段为空
+        std::string data;
+        // 文件或管道描述符，内存数据为-1
+        int fd = -1;
+        // 是否为管道
+        bool pipe = false;
+        // 文件段尚未发送部分的起始偏移
+        off_t offset = 0;
+        // 文件和管道段尚未发送的字节数
+        size_t len = 0;
+    };
+
+    /*
+     * 热升级时移交的一个客户端连接的全部状态
+     */
+    struct HandoffConnection {
+        // 客户端套接字描述符
+        int fd = -1;
+        // 对端网络地址
+        AddrInfo addr_info;
+        // 接收缓冲区中尚未交给回调的数据，如半个帧
+        std::string input;
+        // 发送缓冲区中尚未发送的数据
+        std::vector<HandoffSegment> output;
+        // 使用者通过升级回调保存的连接状态
+        std::string state;
+    };
+
+    /*
+     * 新旧进程间移交监听套接字和客户端连接的Unix域套接字通道
+     * 新进程连接旧进程监听的路径，旧进程依次发送监听描述符、连接批次和结束帧，描述符以SCM_RIGHTS传递；
+     * 每帧附带的描述符不超过kMaxFdsPerFrame个，连接数很多时分多帧发送
+     */
+    class UpgradeChannel {
+
+    public:
+
+        /**
+          * @brief  根据一个已连接的Unix域套接字构造通道，通道析构时关闭该描述符
+          * @param  已连接的Unix域套接字描述符
+          */
+        explicit UpgradeChannel(int fd) : fd_(fd) {}
+
+        ~UpgradeChannel();
+
+        UpgradeChannel(const UpgradeChannel &) = delete;
+
+        UpgradeChannel &operator=(const UpgradeChannel &) = delete;
+
+        /**
+          * @brief  在指定路径上创建非阻塞的Unix域监听套接字，路径上残留的套接字文件会被先删除
+          * @param  套接字路径
+          * @retval 监听套接字描述符，失败时返回-1
+          */
+        static int listen(const std::string &);
+
+        /**
+          * @brief  以阻塞方式连接指定路径上的Unix域套接字
+          * @param  套接字路径
+          * @retval 已连接的套接字描述符，路径不存在或无人监听时返回-1
+          */
+        static int connect(const std::string &);
+
+        /**
+          * @brief  发送监听套接字描述符
+          * @param  监听套接字描述符集合
+          * @retval 是否发送成功
+          */
+        bool sendListeners(const std::vector<int> &);
+
+        /**
+          * @brief  发送一批客户端连接
+          * @param  连接集合
+          * @retval 是否发送成功
+          */
+        bool sendConnections(const std::vector<HandoffConnection> &);
+
+        /**
+          * @brief  发送结束帧并等待接收方确认已完整接收
+          * @note   最多等待kAckTimeoutMs毫秒；返回false时接收方不会使用已收到的描述符，发送方可以继续服务这些连接
+          * @retval 接收方是否确认
+          */
+        bool finish();
+
+        /**
+          * @brief  接收旧进程移交的全部监听套接字和客户端连接，直到结束帧
+          * @note   完整接收后向发送方回复确认；失败时关闭已收到的全部描述符并清空输出参数
+          * @param  _1:监听套接字描述符集合 _2:连接集合
+          * @retval 是否完整接收
+          */
+        bool receive(std::vector<int> &, std::vector<HandoffConnection> &);
+
+    private:
+
+        /**
+          * @brief  发送一帧，描述符附在帧头上
+          * @param  _1:帧类型 _2:帧内的记录数 _3:负载 _4:描述符集合
+          * @retval 是否发送成功
+          */
+        bool sendFrame(uint32_t, uint32_t, const std::string &, const std::vector<int> &);
+
+        /**
+          * @brief  接收一帧
+          * @param  _1:帧类型 _2:帧内的记录数 _3:负载 _4:描述符集合
+          * @retval 是否接收成功
+          */
+        bool recvFrame(uint32_t &, uint32_t &, std::string &, std::vector<int> &);
+
+        // 已连接的Unix域套接字描述符
+        int fd_;
+
+    };
+
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "Poller.h"
+#include <sys/socket.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace CwNetWork {
+
+    /*
+     * 基于io_uring的IO多路复用模型
+     * 以add注册的文件描述符以一个IORING_OP_POLL_ADD请求监听：带EPOLLET的注册使用多次触发的请求(边沿触发)，
+     * 否则使用单次请求并在每次交付后重新提交(水平触发)
+     * 内核支持时以完成模型工作：addListener以多次触发的accept请求交付新连接，addReceiver以多次触发的recv请求
+     * 从一组预先提供的接收缓冲区中交付数据，send以IORING_OP_SEND/SENDMSG提交聚集发送请求；
+     * 交付的接收缓冲区在下一次wait时归还给内核，被内核终止的多次触发请求同时重新提交
+     * 全部请求的增删只向提交队列追加，与下一次wait合并为一次io_uring_enter调用提交
+     */
+    class UringPoller : public Poller {
+
+    public:
+
+        /**
+          * @brief  创建一个io_uring对象，维护提交/完成队列
+          * @note   创建失败或内核不支持IORING_FEAT_EXT_ARG(wait无法带超时等待)时valid返回false
+          * @param  事件数组的初始长度，完成事件更多时自动扩容
+          */
+        explicit UringPoller(int init_size = 128);
+
+        ~UringPoller() override;
+
+        UringPoller(const UringPoller &) = delete;
+
+        UringPoller &operator=(const UringPoller &) = delete;
+
+        bool valid() const override { return ring_fd_ != -1; }
+
+        bool edgeTriggered() const override { return true; }
+
+        bool completionBased() const override { return completions_; }
+
+        /**
+          * @brief  开始监听指定的文件描述符
+          * @note   只向提交队列追加请求，在下一次wait时提交
+          * @param  要加入检测的文件描述符、关心的事件、用户自定义类型指针
+          * @retval 是否成功加入提交队列
+          */
+        bool add(int, uint32_t, void *) override;
+
+        /**
+          * @brief  修改指定文件描述符关心的事件
+          * @note   只向提交队列追加请求，在下一次wait时提交
+          * @param  要修改的文件描述符、关心的事件、用户自定义类型指针
+          * @retval 是否成功加入提交队列
+          */
+        bool mod(int, uint32_t, void *) override;
+
+        /**
+          * @brief  停止监听指定的文件描述符
+          * @note   该函数不会关闭该fd；在下一次wait提交之前内核仍持有该文件的引用
+          * @param  要删除的fd
+          * @retval 是否成功加入提交队列
+          */
+        bool del(int) override;
+
+        /**
+          * @brief  提交全部待提交的请求并等待I/O事件
+          * @param  参数timeout是超时时间(毫秒，0会立即返回，-1是永久阻塞)
+          * @retval 就绪事件个数，出错返回-1
+          */
+        int wait(int) override;
+
+        /**
+          * @brief  以多次触发的accept请求监听服务端套接字
+          * @note   只向提交队列追加请求，在下一次wait时提交
+          * @param  服务端套接字描述符、用户自定义类型指针
+          * @retval 是否成功加入提交队列，不支持完成模型时返回false
+          */
+        bool addListener(int, void *) override;
+
+        /**
+          * @brief  开始监听指定的流式套接字，EPOLLIN以多次触发的recv请求提供，其余事件以监听请求提供
+          * @note   只向提交队列追加请求，在下一次wait时提交
+          * @param  要加入检测的文件描述符、关心的事件、用户自定义类型指针
+          * @retval 是否成功加入提交队列，不支持完成模型时返回false
+          */
+        bool addReceiver(int, uint32_t, void *) override;
+
+        /**
+          * @brief  提交一个聚集发送请求，单个数据块使用IORING_OP_SEND，多个使用IORING_OP_SENDMSG
+          * @note   只向提交队列追加请求，在下一次wait时提交
+          * @param  _1:文件描述符 _2:数据块数组 _3:数据块数 _4:send的flags
+          * @retval 是否成功加入提交队列
+          */
+        bool send(int, const struct iovec *, size_t, int) override;
+
+        /**
+          * @brief  停止监听指定的文件描述符，撤销其上全部未结束的请求并阻塞等待它们结束
+          * @note   等待期间收到的其他描述符的完成事件保存下来，由下一次wait按原顺序交付
+          * @param  _1:文件描述符 _2:保存该描述符尚未交付的完成事件
+          */
+        void settle(int, std::vector<Result> &) override;
+
+    private:
+
+        /*
+         * 注册的工作方式
+         * POLL: 全部事件以监听请求提供  LISTENER: 多次触发的accept请求  RECEIVER: EPOLLIN以多次触发的recv请求提供
+         */
+        enum class Mode : uint8_t {
+            POLL, LISTENER, RECEIVER
+        };
+
+        // SENDMSG请求的消息头与数据块数组，在请求结束前保持有效
+        struct SendOp {
+            struct msghdr msg;
+            struct iovec iov[kMaxSendIov];
+        };
+
+        struct Registration {
+            // 关心的事件
+            uint32_t events = 0;
+            // 用户数据
+            epoll_data_t data{};
+            // 监听请求的序号，用于丢弃已撤销的监听请求残留的完成事件
+            uint32_t seq = 0;
+            // 发送请求的序号
+            uint32_t send_seq = 0;
+            // 注册代数，每次停止监听时自增，多次触发请求和发送请求的完成事件以此识别所属的注册
+            uint16_t gen = 0;
+            // 多次触发请求的序号
+            uint16_t multi_seq = 0;
+            // 尚未结束(未收到不带IORING_CQE_F_MORE的完成事件)的多次触发请求数，包括已撤销的
+            uint16_t multi_live = 0;
+            // 工作方式
+            Mode mode = Mode::POLL;
+            // 是否正在监听
+            bool active = false;
+            // 是否有已提交且未撤销的监听请求
+            bool polling = false;
+            // 是否有已提交且未撤销的多次触发请求
+            bool multi_armed = false;
+            // 是否有未结束的发送请求
+            bool sending = false;
+            // 是否正在settle中等待全部请求结束
+            bool settling = false;
+            // 未结束的SENDMSG请求使用的消息头，单个数据块的发送请求为nullptr
+            SendOp *send_op = nullptr;
+        };
+
+        // 完成事件中用到的字段
+        struct Cqe {
+            uint64_t user_data;
+            int32_t res;
+            uint32_t flags;
+        };
+
+        /**
+          * @brief  映射接收缓冲区并提供给内核，以一对Unix域套接字检测多次触发的recv请求是否可用
+          * @retval 是否可以完成模型工作
+          */
+        bool setupCompletions();
+
+        /**
+          * @brief  将编号从start开始的count个接收缓冲区提供给内核
+          * @param  _1:起始编号 _2:缓冲区个数
+          * @retval 是否成功加入提交队列
+          */
+        bool provideBuffers(unsigned, unsigned);
+
+        /**
+          * @brief  归还上一轮交付的接收缓冲区，重新提交被内核终止的多次触发请求
+          */
+        void recycle();
+
+        /**
+          * @brief  获取一个空闲的提交队列项，提交队列已满时先提交
+          * @retval 清零后的提交队列项，失败返回nullptr
+          */
+        struct io_uring_sqe *getSqe();
+
+        /**
+          * @brief  按注册的事件为指定的文件描述符提交监听请求
+          * @param  文件描述符
+          * @retval 是否成功加入提交队列
+          */
+        bool arm(int);
+
+        /**
+          * @brief  撤销指定文件描述符当前的监听请求
+          * @param  文件描述符
+          * @retval 是否成功加入提交队列
+          */
+        bool disarm(int);
+
+        /**
+          * @brief  为指定的文件描述符提交多次触发的accept或recv请求
+          * @param  文件描述符
+          * @retval 是否成功加入提交队列
+          */
+        bool armMulti(int);
+
+        /**
+          * @brief  撤销指定文件描述符当前的多次触发请求，已完成的部分仍会交付
+          * @param  文件描述符
+          * @retval 是否成功加入提交队列
+          */
+        bool disarmMulti(int);
+
+        /**
+          * @brief  撤销指定文件描述符未结束的发送请求
+          * @param  文件描述符
+          * @retval 是否成功加入提交队列
+          */
+        bool cancelSend(int);
+
+        /**
+          * @brief  处理一个完成事件，更新注册状态
+          * @param  _1:完成事件 _2:保存交付的结果 _3:保存就绪事件的事件掩码
+          * @retval 需要交付的文件描述符，无需交付时返回-1
+          */
+        int complete(const Cqe &, Result &, uint32_t &);
+
+        /**
+          * @brief  调用io_uring_enter提交请求并等待完成事件
+          * @param  _1:至少等待的完成事件数 _2:超时时间(毫秒，-1为永久)
+          * @retval io_uring_enter的返回值
+          */
+        int enter(unsigned, int);
+
+        /**
+          * @brief  取出完成队列中的全部事件
+          * @param  追加取出的事件
+          */
+        void reap(std::vector<Cqe> &);
+
+        /**
+          * @brief  将settle期间保存的和完成队列中的事件转换到epoll_event数组
+          * @retval 转换的事件个数
+          */
+        int harvest();
+
+        /**
+          * @brief  释放内核资源和映射的内存
+          */
+        void release();
+
+        // io_uring文件描述符
+        int ring_fd_ = -1;
+        // 以文件描述符为下标的注册信息
+        std::vector<Registration> regs_;
+        // 提交队列与完成队列的映射区域
+        void *sq_ptr_ = nullptr;
+        void *cq_ptr_ = nullptr;
+        size_t sq_ring_size_ = 0;
+        size_t cq_ring_size_ = 0;
+        struct io_uring_sqe *sqes_ = nullptr;
+        size_t sqes_size_ = 0;
+        // 提交队列
+        unsigned *sq_head_ = nullptr;
+        unsigned *sq_tail_ = nullptr;
+        unsigned sq_mask_ = 0;
+        unsigned sq_entries_ = 0;
+        // 本地提交队列尾和尚未提交的请求数
+        unsigned sq_local_tail_ = 0;
+        unsigned to_submit_ = 0;
+        // 完成队列
+        unsigned *cq_head_ = nullptr;
+        unsigned *cq_tail_ = nullptr;
+        unsigned cq_mask_ = 0;
+        struct io_uring_cqe *cqes_ = nullptr;
+        // 是否以完成模型工作
+        bool completions_ = false;
+        // 接收缓冲区的映射区域
+        char *buffers_ = nullptr;
+        // 上一轮交付、尚未归还的接收缓冲区编号
+        std::vector<uint16_t> used_buffers_;
+        // 被内核终止、等待重新提交的多次触发请求的文件描述符
+        std::vector<int> rearm_;
+        // 待交付的完成事件，包括settle期间收到的其他描述符的事件
+        std::vector<Cqe> backlog_;
+        // 空闲的SENDMSG消息头
+        std::vector<std::unique_ptr<SendOp>> send_ops_;
+
+    };
+
+}
@@ -1,9 +1,106 @@
 #include "AddrInfo.h"
+#include <cstring>
+#include <cstddef>
 
+using namespace std;
 using namespace CwNetWork;
 
+const socklen_t AddrInfo::kMaxSockLen = sizeof(AddrInfo::Storage);
+
+AddrInfo::AddrInfo(const struct sockaddr *addr, socklen_t len) {
+    setSockLen(len);
+    memcpy(&addr_, addr, len_);
+}
+
 AddrInfo::AddrInfo(const char *ip, unsigned short port) {
-    addr_.sin_family = AF_INET;  //使用IPv4地址
-    addr_.sin_addr.s_addr = inet_addr(ip);  //具体的IP地址
-    addr_.sin_port = htons(port);
+    if (strchr(ip, ':') != nullptr) {
+        len_ = sizeof(struct sockaddr_in6);
+        addr_.in6.sin6_family = AF_INET6;
+        addr_.in6.sin6_port = htons(port);
+        if (inet_pton(AF_INET6, ip, &addr_.in6.sin6_addr) != 1) {
+            addr_.sa.sa_family = AF_UNSPEC;
+        }
+        return;
+    }
+    addr_.in.sin_family = AF_INET;  //使用IPv4地址
+    addr_.in.sin_addr.s_addr = inet_addr(ip);  //具体的IP地址
+    addr_.in.sin_port = htons(port);
+}
+
+AddrInfo AddrInfo::anyAddress(unsigned short port, bool ipv6) {
+    AddrInfo info;
+    if (ipv6) {
+        info.len_ = sizeof(struct sockaddr_in6);
+        info.addr_.in6.sin6_family = AF_INET6;
+        info.addr_.in6.sin6_addr = in6addr_any;
+        info.addr_.in6.sin6_port = htons(port);
+    } else {
+        info.addr_.in.sin_family = AF_INET;
+        info.addr_.in.sin_addr.s_addr = htonl(INADDR_ANY);
+        info.addr_.in.sin_port = htons(port);
+    }
+    return info;
+}
+
+AddrInfo AddrInfo::unixPath(const string &path) {
+    AddrInfo info;
+    if (path.empty() || path.size() >= sizeof(info.addr_.un.sun_path)) {
+        info.addr_.sa.sa_family = AF_UNSPEC;
+        return info;
+    }
+    info.addr_.un.sun_family = AF_UNIX;
+    memcpy(info.addr_.un.sun_path, path.data(), path.size());
+    if (path[0] == '@') {
+        // 抽象命名空间以'\0'开头，地址长度不含结尾的'\0'
+        info.addr_.un.sun_path[0] = '\0';
+        info.len_ = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + path.size());
+    } else {
+        info.len_ = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path) + path.size() + 1);
+    }
+    return info;
+}
+
+string AddrInfo::getIp() const {
+    char ip[INET6_ADDRSTRLEN] = {0};
+    if (getFamily() == AF_INET) {
+        inet_ntop(AF_INET, &addr_.in.sin_addr, ip, sizeof(ip));
+    } else if (getFamily() == AF_INET6) {
+        inet_ntop(AF_INET6, &addr_.in6.sin6_addr, ip, sizeof(ip));
+    }
+    return ip;
+}
+
+unsigned short AddrInfo::getPort() const {
+    if (getFamily() == AF_INET) {
+        return ntohs(addr_.in.sin_port);
+    } else if (getFamily() == AF_INET6) {
+        return ntohs(addr_.in6.sin6_port);
+    }
+    return 0;
+}
+
+string AddrInfo::getPath() const {
+    auto offset = static_cast<socklen_t>(offsetof(struct sockaddr_un, sun_path));
+    if (getFamily() != AF_UNIX || len_ <= offset) {
+        return {};
+    }
+    const char *path = addr_.un.sun_path;
+    size_t len = len_ - offset;
+    if (path[0] == '\0') {
+        return "@" + string(path + 1, len - 1);
+    }
+    return {path, strnlen(path, len)};
+}
+
+string AddrInfo::toString() const {
+    switch (getFamily()) {
+        case AF_INET:
+            return getIp() + ":" + to_string(getPort());
+        case AF_INET6:
+            return "[" + getIp() + "]:" + to_string(getPort());
+        case AF_UNIX:
+            return "unix:" + getPath();
+        default:
+            return "unspecified";
+    }
 }
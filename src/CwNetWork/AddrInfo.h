@@ -2,11 +2,16 @@
 
 #include <string>
 #include <arpa/inet.h>
+#include <sys/un.h>
 
 namespace CwNetWork {
 
+    // IPv4网络地址的长度
     static socklen_t kSocklen = sizeof(struct sockaddr_in);
 
+    /*
+     * 网络地址，可以是IPv4、IPv6或Unix域套接字地址
+     */
     class AddrInfo {
 
     public:
@@ -23,13 +28,19 @@ namespace CwNetWork {
           * @brief  根据一个网络地址构造网络地址对象
           * @param  原生sockaddr_in结构体
           */
-        explicit AddrInfo(sockaddr_in addr) : addr_(addr) {}
+        explicit AddrInfo(sockaddr_in addr) { setSockAddr_in(addr); }
+
+        /**
+          * @brief  根据任意协议族的原生地址构造网络地址对象
+          * @note   长度超过kMaxSockLen时截断
+          * @param  _1:原生地址 _2:地址长度
+          */
+        AddrInfo(const struct sockaddr *, socklen_t);
 
         /**
           * @brief  根据参数构造一个网络地址对象
-          * @note   None
+          * @note   ip中含有':'时按IPv6地址解析，否则按IPv4地址解析；解析失败时地址族为AF_UNSPEC
           * @param  _1:网路地址对象的ip _2:网络地址对象的端口
-          * @retval None
           */
         AddrInfo(const char *, unsigned short);
 
@@ -39,33 +50,94 @@ namespace CwNetWork {
           */
         AddrInfo(const std::string &ip, unsigned short port) : AddrInfo(ip.c_str(), port) {}
 
+        /**
+          * @brief  构造监听本机全部地址的网络地址对象
+          * @note   IPv6的通配地址在net.ipv6.bindv6only为0(默认)时同时接受IPv4连接
+          * @param  _1:端口 _2:是否为IPv6
+          * @retval AddrInfo
+          */
+        static AddrInfo anyAddress(unsigned short, bool ipv6 = false);
+
+        /**
+          * @brief  构造Unix域套接字地址
+          * @note   以'@'开头的路径表示抽象命名空间，不在文件系统中创建文件；路径过长时地址族为AF_UNSPEC
+          * @param  套接字路径
+          * @retval AddrInfo
+          */
+        static AddrInfo unixPath(const std::string &);
+
+        /**
+          * @brief  获取地址族
+          * @retval AF_INET、AF_INET6、AF_UNIX或AF_UNSPEC
+          */
+        sa_family_t getFamily() const { return addr_.sa.sa_family; }
+
         /**
           * @brief  获取该网络地址对象的ip
-          * @retval C++风格字符串
+          * @retval C++风格字符串，Unix域套接字地址为空
           */
-        std::string getIp() const { return {inet_ntoa(addr_.sin_addr)}; }
+        std::string getIp() const;
 
         /**
           * @brief  获取该网络地址对象的端口
-          * @retval 端口号的值
+          * @retval 端口号的值，Unix域套接字地址为0
+          */
+        unsigned short getPort() const;
+
+        /**
+          * @brief  获取Unix域套接字路径
+          * @retval 路径，抽象命名空间以'@'开头；未绑定的对端及非Unix域地址为空
           */
-        unsigned short getPort() const { return ntohs(addr_.sin_port); }
+        std::string getPath() const;
+
+        /**
+          * @brief  获取可读的地址表示，如1.2.3.4:80、[::1]:80、unix:/run/app.sock
+          * @retval C++风格字符串
+          */
+        std::string toString() const;
 
         /**
           * @brief  设置sockaddr_in成员
           * @param  要设置的sockaddr_in
           */
-        void setSockAddr_in(struct sockaddr_in addr) { addr_ = addr; }
+        void setSockAddr_in(struct sockaddr_in addr) {
+            addr_.in = addr;
+            len_ = sizeof(addr);
+        }
 
         /**
           * @brief  获取该网络地址的sockaddr指针用于其他接口的参数传递
           * @retval struct sockaddr *
           */
-        struct sockaddr *getSockAddrPtr() const { return (struct sockaddr *) &addr_; }
+        struct sockaddr *getSockAddrPtr() const { return const_cast<struct sockaddr *>(&addr_.sa); }
+
+        /**
+          * @brief  获取地址的有效长度，用于bind、connect等接口
+          * @retval 地址长度
+          */
+        socklen_t getSockLen() const { return len_; }
+
+        /**
+          * @brief  设置地址的有效长度，用于accept、recvfrom等接口填写地址之后
+          * @param  地址长度
+          */
+        void setSockLen(socklen_t len) { len_ = len < kMaxSockLen ? len : kMaxSockLen; }
+
+        // 能够容纳的最大地址长度
+        static const socklen_t kMaxSockLen;
 
     private:
 
-        struct sockaddr_in addr_ = {0};
+        union Storage {
+            struct sockaddr sa;
+            struct sockaddr_in in;
+            struct sockaddr_in6 in6;
+            struct sockaddr_un un;
+        };
+
+        Storage addr_ = {};
+        // 地址的有效长度
+        socklen_t len_ = sizeof(struct sockaddr_in);
 
     };
 
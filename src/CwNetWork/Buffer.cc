@@ -0,0 +1,114 @@
+#include "Buffer.h"
+#include "BufferPool.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
+
+using namespace std;
+using namespace CwNetWork;
+
+void Buffer::retrieve(size_t len) {
+    if (len < readableBytes()) {
+        reader_index_ += len;
+    } else {
+        retrieveAll();
+    }
+}
+
+void Buffer::retrieveAll() {
+    reader_index_ = kCheapPrepend;
+    writer_index_ = kCheapPrepend;
+}
+
+string Buffer::retrieveAllAsString() {
+    string result(peek(), readableBytes());
+    retrieveAll();
+    return result;
+}
+
+void Buffer::append(const char *data, size_t len) {
+    ensureWritableBytes(len);
+    memcpy(beginWrite(), data, len);
+    hasWritten(len);
+}
+
+void Buffer::prepend(const void *data, size_t len) {
+    reader_index_ -= len;
+    memcpy(data_ + reader_index_, data, len);
+}
+
+void Buffer::ensureWritableBytes(size_t len) {
+    if (writableBytes() < len) {
+        makeSpace(len);
+    }
+}
+
+ssize_t Buffer::readFd(int fd, int *saved_errno) {
+    char spill[kSpillSize];
+    struct iovec vec[2];
+    size_t writable = writableBytes();
+    vec[0].iov_base = beginWrite();
+    vec[0].iov_len = writable;
+    vec[1].iov_base = spill;
+    vec[1].iov_len = sizeof(spill);
+    ssize_t n = readv(fd, vec, 2);
+    if (n < 0) {
+        *saved_errno = errno;
+    } else if (static_cast<size_t>(n) <= writable) {
+        writer_index_ += n;
+    } else {
+        writer_index_ += writable;
+        append(spill, n - writable);
+    }
+    return n;
+}
+
+void Buffer::release() {
+    freeStorage();
+    retrieveAll();
+}
+
+void Buffer::makeSpace(size_t len) {
+    size_t readable = readableBytes();
+    if (data_ != nullptr && writableBytes() + prependableBytes() - kCheapPrepend >= len) {
+        memmove(data_ + kCheapPrepend, peek(), readable);
+        reader_index_ = kCheapPrepend;
+        writer_index_ = reader_index_ + readable;
+        return;
+    }
+    size_t need = kCheapPrepend + readable + len;
+    char *storage = nullptr;
+    size_t size = 0;
+    bool pooled = false;
+    if (pool_ != nullptr && need <= pool_->getBlockSize()) {
+        storage = pool_->acquire();
+        size = pool_->getBlockSize();
+        pooled = storage != nullptr;
+    }
+    if (storage == nullptr) {
+        // 池已耗尽或超出块大小，在堆上按至少翻倍扩容
+        size = max(need, size_ * 2);
+        storage = new char[size];
+    }
+    if (readable > 0) {
+        memcpy(storage + kCheapPrepend, peek(), readable);
+    }
+    freeStorage();
+    data_ = storage;
+    size_ = size;
+    pooled_ = pooled;
+    reader_index_ = kCheapPrepend;
+    writer_index_ = reader_index_ + readable;
+}
+
+void Buffer::freeStorage() {
+    if (pooled_) {
+        pool_->release(data_);
+    } else {
+        delete[] data_;
+    }
+    data_ = nullptr;
+    size_ = 0;
+    pooled_ = false;
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <string>
+#include <sys/types.h>
+
+namespace CwNetWork {
+
+    class BufferPool;
+
+    /*
+     * 连接的接收缓冲区，内存布局如下:
+     * +-------------------+------------------+------------------+
+     * | prependable bytes |  readable bytes  |  writable bytes  |
+     * +-------------------+------------------+------------------+
+     * 0      <=      reader_index   <=   writer_index   <=   size
+     * 设置了内存块池时，所需容量不超过块大小的存储从池中借用，更大时改为堆上分配；release将借用的块归还给池
+     */
+    class Buffer {
+
+    public:
+
+        // 头部预留空间大小，便于在数据前追加长度等头部
+        static const size_t kCheapPrepend = 8;
+        // readFd使用的栈上溢出缓冲区大小
+        static const size_t kSpillSize = 65536;
+
+        Buffer() = default;
+
+        ~Buffer() { freeStorage(); }
+
+        Buffer(const Buffer &) = delete;
+
+        Buffer &operator=(const Buffer &) = delete;
+
+        /**
+          * @brief  获取可读字节数
+          * @retval 可读字节数
+          */
+        size_t readableBytes() const { return writer_index_ - reader_index_; }
+
+        /**
+          * @brief  获取可写字节数
+          * @retval 可写字节数
+          */
+        size_t writableBytes() const { return size_ > writer_index_ ? size_ - writer_index_ : 0; }
+
+        /**
+          * @brief  获取头部可预留字节数
+          * @retval 头部可预留字节数
+          */
+        size_t prependableBytes() const { return reader_index_; }
+
+        /**
+          * @brief  获取缓冲区已分配的容量
+          * @retval 已分配的容量
+          */
+        size_t capacity() const { return size_; }
+
+        /**
+          * @brief  判断存储是否借用自内存块池
+          * @retval 是否借用自内存块池
+          */
+        bool pooled() const { return pooled_; }
+
+        /**
+          * @brief  设置借用存储的内存块池
+          * @note   只能在未分配存储时调用，池必须后于缓冲区析构
+          * @param  内存块池，为空表示总在堆上分配
+          */
+        void setPool(BufferPool *pool) { pool_ = pool; }
+
+        /**
+          * @brief  获取可读数据的起始地址
+          * @retval 可读数据的起始地址
+          */
+        const char *peek() const { return data_ + reader_index_; }
+
+        /**
+          * @brief  获取可写区域的起始地址
+          * @retval 可写区域的起始地址
+          */
+        char *beginWrite() { return data_ + writer_index_; }
+
+        /**
+          * @brief  标记已向可写区域写入指定字节数
+          * @param  写入的字节数
+          */
+        void hasWritten(size_t len) { writer_index_ += len; }
+
+        /**
+          * @brief  丢弃指定字节数的可读数据
+          * @param  丢弃的字节数
+          */
+        void retrieve(size_t);
+
+        /**
+          * @brief  丢弃全部可读数据，保留已分配的容量
+          */
+        void retrieveAll();
+
+        /**
+          * @brief  取出全部可读数据
+          * @retval 可读数据
+          */
+        std::string retrieveAllAsString();
+
+        /**
+          * @brief  追加数据到可读数据末尾
+          * @param  _1:数据起始地址 _2:数据长度
+          */
+        void append(const char *, size_t);
+
+        /**
+          * @brief  在可读数据前追加数据
+          * @note   调用方需确保prependableBytes不小于数据长度
+          * @param  _1:数据起始地址 _2:数据长度
+          */
+        void prepend(const void *, size_t);
+
+        /**
+          * @brief  确保至少有指定字节数的可写区域
+          * @param  需要的可写字节数
+          */
+        void ensureWritableBytes(size_t);
+
+        /**
+          * @brief  以一次readv调用从文件描述符读取数据
+          * @note   同时读入缓冲区可写区域和栈上的kSpillSize字节溢出区，溢出的数据再追加到缓冲区
+          * @param  _1:文件描述符 _2:出错时保存errno
+          * @retval 读取的字节数，对端关闭返回0，出错返回-1
+          */
+        ssize_t readFd(int, int *);
+
+        /**
+          * @brief  释放缓冲区占用的全部内存，借用的块归还给内存块池
+          * @note   只能在没有可读数据时调用
+          */
+        void release();
+
+    private:
+
+        /**
+          * @brief  腾挪或扩容以获得指定字节数的可写区域
+          * @param  需要的可写字节数
+          */
+        void makeSpace(size_t);
+
+        /**
+          * @brief  释放存储，借用的块归还给内存块池
+          */
+        void freeStorage();
+
+        // 缓冲区存储，首次写入时才分配
+        char *data_ = nullptr;
+        // 存储的容量
+        size_t size_ = 0;
+        // 借用存储的内存块池
+        BufferPool *pool_ = nullptr;
+        // 存储是否借用自内存块池
+        bool pooled_ = false;
+        // 可读数据起始下标
+        size_t reader_index_ = kCheapPrepend;
+        // 可写区域起始下标
+        size_t writer_index_ = kCheapPrepend;
+
+    };
+
+}
@@ -0,0 +1,124 @@
+#include "BufferPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <sys/mman.h>
+
+using namespace std;
+using namespace CwNetWork;
+
+// 为每个线程分配一个分片下标
+static atomic<size_t> next_shard{0};
+static thread_local size_t t_shard = next_shard.fetch_add(1, memory_order_relaxed);
+
+BufferPool::BufferPool(size_t block_size, size_t max_blocks, bool huge_pages)
+        : block_size_((max(block_size, sizeof(FreeBlock)) + 63) & ~static_cast<size_t>(63)),
+          max_blocks_(max_blocks), huge_pages_(huge_pages) {}
+
+BufferPool::~BufferPool() {
+    for (auto &region: regions_) {
+        munmap(region.first, region.second);
+    }
+}
+
+void *BufferPool::operator new(size_t size) {
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, alignof(BufferPool), size) != 0) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+void BufferPool::operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+char *BufferPool::acquire() {
+    Shard &local = localShard();
+    {
+        lock_guard<mutex> lock(local.mutex);
+        if (local.head != nullptr) {
+            FreeBlock *block = local.head;
+            local.head = block->next;
+            used_count_.fetch_add(1, memory_order_relaxed);
+            return reinterpret_cast<char *>(block);
+        }
+    }
+    char *block = carve();
+    if (block != nullptr) {
+        used_count_.fetch_add(1, memory_order_relaxed);
+        return block;
+    }
+    // 已达到最大块数，从其他线程的分片中取回空闲块
+    for (auto &shard: shards_) {
+        lock_guard<mutex> lock(shard.mutex);
+        if (shard.head != nullptr) {
+            FreeBlock *free_block = shard.head;
+            shard.head = free_block->next;
+            used_count_.fetch_add(1, memory_order_relaxed);
+            return reinterpret_cast<char *>(free_block);
+        }
+    }
+    return nullptr;
+}
+
+void BufferPool::release(char *data) {
+    if (data == nullptr) {
+        return;
+    }
+    auto block = reinterpret_cast<FreeBlock *>(data);
+    Shard &local = localShard();
+    {
+        lock_guard<mutex> lock(local.mutex);
+        block->next = local.head;
+        local.head = block;
+    }
+    used_count_.fetch_sub(1, memory_order_relaxed);
+}
+
+size_t BufferPool::getMappedBytes() const {
+    lock_guard<mutex> lock(region_mutex_);
+    size_t bytes = 0;
+    for (auto &region: regions_) {
+        bytes += region.second;
+    }
+    return bytes;
+}
+
+BufferPool::Shard &BufferPool::localShard() {
+    return shards_[t_shard % kShardNum];
+}
+
+char *BufferPool::carve() {
+    lock_guard<mutex> lock(region_mutex_);
+    if (max_blocks_ > 0 && block_count_.load(memory_order_relaxed) >= max_blocks_) {
+        return nullptr;
+    }
+    if (carve_next_ == nullptr || static_cast<size_t>(carve_end_ - carve_next_) < block_size_) {
+        // 块大于区域时按块大小向上取整到区域大小的整数倍
+        size_t len = (block_size_ + kRegionSize - 1) / kRegionSize * kRegionSize;
+        void *region = MAP_FAILED;
+        if (huge_pages_) {
+            region = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (region != MAP_FAILED) {
+                huge_mapped_.store(true, memory_order_relaxed);
+            }
+        }
+        if (region == MAP_FAILED) {
+            region = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (region == MAP_FAILED) {
+                return nullptr;
+            }
+            if (huge_pages_) {
+                madvise(region, len, MADV_HUGEPAGE);
+            }
+        }
+        regions_.emplace_back(static_cast<char *>(region), len);
+        carve_next_ = static_cast<char *>(region);
+        carve_end_ = carve_next_ + len;
+    }
+    char *block = carve_next_;
+    carve_next_ += block_size_;
+    block_count_.fetch_add(1, memory_order_relaxed);
+    return block;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace CwNetWork {
+
+    /*
+     * 固定大小内存块的共享池，供连接的接收缓冲区在有数据在途时借用、空闲时归还
+     * 内存以kRegionSize为单位mmap整块映射，块只在首次借出时才从区域中切出，未借出过的页不占用物理内存；
+     * 归还的块挂入按线程分片的空闲链表，各事件循环线程大多落在不同分片上，互不争用同一把锁。
+     * 区域在池析构时才解除映射，因此池必须后于全部借用者析构
+     */
+    class BufferPool {
+
+    public:
+
+        // 每次映射的区域大小，与x86-64的大页大小一致
+        static const size_t kRegionSize = 2 * 1024 * 1024;
+        // 空闲链表的分片数
+        static const size_t kShardNum = 16;
+
+        /**
+          * @brief  构造一个内存块池
+          * @note   块大小向上取整到64字节以免相邻块共享缓存行；不映射任何内存，首次借出时才映射第一个区域
+          * @param  _1:块大小 _2:最多切出的块数，0表示不限制 _3:是否尝试以MAP_HUGETLB大页映射区域
+          */
+        explicit BufferPool(size_t block_size, size_t max_blocks = 0, bool huge_pages = false);
+
+        ~BufferPool();
+
+        BufferPool(const BufferPool &) = delete;
+
+        BufferPool &operator=(const BufferPool &) = delete;
+
+        /**
+          * @brief  按分片的缓存行对齐分配池对象
+          * @note   C++14的new不保证超过alignof(max_align_t)的对齐，由posix_memalign分配
+          * @param  对象大小
+          * @retval 对象的起始地址，分配失败时抛出std::bad_alloc
+          */
+        static void *operator new(size_t);
+
+        /**
+          * @brief  释放由operator new分配的池对象
+          * @param  对象的起始地址
+          */
+        static void operator delete(void *) noexcept;
+
+        /**
+          * @brief  借出一个内存块
+          * @note   线程安全
+          * @retval 块的起始地址，已达到最大块数或映射失败时返回nullptr
+          */
+        char *acquire();
+
+        /**
+          * @brief  归还一个由acquire借出的内存块
+          * @note   线程安全，可以在与借出时不同的线程中归还
+          * @param  块的起始地址
+          */
+        void release(char *);
+
+        /**
+          * @brief  获取块大小
+          * @retval 块大小
+          */
+        size_t getBlockSize() const { return block_size_; }
+
+        /**
+          * @brief  获取已从区域中切出的块数
+          * @retval 块数
+          */
+        size_t getBlockCount() const { return block_count_.load(std::memory_order_relaxed); }
+
+        /**
+          * @brief  获取当前借出未还的块数
+          * @retval 块数
+          */
+        size_t getUsedCount() const { return used_count_.load(std::memory_order_relaxed); }
+
+        /**
+          * @brief  获取已映射的内存字节数
+          * @retval 字节数
+          */
+        size_t getMappedBytes() const;
+
+        /**
+          * @brief  判断是否有区域以MAP_HUGETLB大页映射
+          * @note   系统未预留大页(vm.nr_hugepages)时退回普通页映射并以MADV_HUGEPAGE建议透明大页
+          * @retval 是否使用了大页
+          */
+        bool usesHugePages() const { return huge_mapped_.load(std::memory_order_relaxed); }
+
+    private:
+
+        struct FreeBlock {
+            // 同一分片空闲链表中的下一个块
+            FreeBlock *next;
+        };
+
+        struct alignas(64) Shard {
+            // 保护空闲链表
+            std::mutex mutex;
+            // 空闲链表头
+            FreeBlock *head = nullptr;
+        };
+
+        /**
+          * @brief  获取当前线程对应的分片
+          * @retval 分片
+          */
+        Shard &localShard();
+
+        /**
+          * @brief  从当前区域切出一个块，区域用尽时映射新的区域
+          * @retval 块的起始地址，已达到最大块数或映射失败时返回nullptr
+          */
+        char *carve();
+
+        // 块大小
+        size_t block_size_;
+        // 最多切出的块数，0表示不限制
+        size_t max_blocks_;
+        // 是否尝试大页映射
+        bool huge_pages_;
+        // 按线程分片的空闲链表
+        Shard shards_[kShardNum];
+        // 保护区域列表和切分位置
+        mutable std::mutex region_mutex_;
+        // 已映射的区域起始地址和长度
+        std::vector<std::pair<char *, size_t>> regions_;
+        // 当前区域中下一个未切出的块
+        char *carve_next_ = nullptr;
+        // 当前区域的末尾
+        char *carve_end_ = nullptr;
+        // 已切出的块数
+        std::atomic<size_t> block_count_{0};
+        // 借出未还的块数
+        std::atomic<size_t> used_count_{0};
+        // 是否有区域以大页映射
+        std::atomic<bool> huge_mapped_{false};
+
+    };
+
+}
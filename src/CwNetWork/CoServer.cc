@@ -0,0 +1,148 @@
+#include "CoServer.h"
+
+#ifdef CW_COROUTINE
+
+#include <stdexcept>
+#include <utility>
+
+using namespace std;
+using namespace CwNetWork;
+
+/*
+ * 保存在连接上下文中的协程层状态，连接断开时随上下文析构，唤醒仍在等待的协程
+ */
+struct Attachment {
+    explicit Attachment(shared_ptr<CoConnection::State> state) : state(std::move(state)) {}
+
+    ~Attachment();
+
+    // 连接状态，处理协程持有另一份引用
+    shared_ptr<CoConnection::State> state;
+};
+
+/*
+ * sleep挂起的协程，延迟任务未执行就随事件循环析构时销毁该协程
+ */
+struct SleepTimer {
+    explicit SleepTimer(coroutine_handle<> handle) : handle(handle) {}
+
+    ~SleepTimer() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    // 挂起的协程，恢复后为空
+    coroutine_handle<> handle;
+};
+
+// 恢复等待中的协程，恢复前清空句柄以便协程再次挂起时重新登记
+static void wake(coroutine_handle<> &handle) {
+    if (handle) {
+        exchange(handle, nullptr).resume();
+    }
+}
+
+// 获取连接上下文中的协程层状态，不是由协程层建立的连接返回nullptr
+static CoConnection::State *stateOf(TcpServer *server, const Socket &client) {
+    auto attachment = static_cast<Attachment *>(server->getContext(client).get());
+    return attachment != nullptr ? attachment->state.get() : nullptr;
+}
+
+Attachment::~Attachment() {
+    state->closed = true;
+    state->blocked = false;
+    wake(state->reader);
+    wake(state->writer);
+}
+
+string CoConnection::ReadAwaiter::await_resume() {
+    deque<string> &messages = state_->messages;
+    if (messages.empty()) {
+        return string();
+    }
+    string data = std::move(messages.front());
+    messages.pop_front();
+    while (!frame_ && !messages.empty()) {
+        data += messages.front();
+        messages.pop_front();
+    }
+    return data;
+}
+
+CoConnection::WriteAwaiter CoConnection::write(const string &data) {
+    if (state_->closed) {
+        return WriteAwaiter(state_.get(), false);
+    }
+    state_->server->sendAll(state_->client, data);
+    return WriteAwaiter(state_.get(), true);
+}
+
+CoConnection::WriteAwaiter CoConnection::writeFrame(const string &message) {
+    if (state_->closed) {
+        return WriteAwaiter(state_.get(), false);
+    }
+    state_->server->sendFrame(state_->client, message);
+    return WriteAwaiter(state_.get(), true);
+}
+
+void CoConnection::close() {
+    if (!state_->closed) {
+        state_->closed = true;
+        state_->server->disConnect(state_->client);
+    }
+}
+
+void SleepAwaiter::await_suspend(coroutine_handle<> handle) {
+    EventLoop *loop = EventLoop::current();
+    if (loop == nullptr) {
+        throw runtime_error("sleep can only be awaited in an event loop thread");
+    }
+    auto timer = make_shared<SleepTimer>(handle);
+    loop->runAfter(delay_ms_, [timer]() {
+        exchange(timer->handle, nullptr).resume();
+    });
+}
+
+CoServer::CoServer(TcpServer *server, Handler handler) : server_(server), handler_(std::move(handler)) {
+    server_->setConnectCallBack([this](const Socket &client, TcpServer *const) {
+        onConnect(client);
+    });
+    server_->setMessageCallBack([this](Socket client, const char *data, size_t len, TcpServer *const) {
+        onMessage(client, data, len);
+    });
+}
+
+void CoServer::setWaterMarks(size_t high_water_mark, size_t low_water_mark) {
+    server_->setWaterMarks(high_water_mark, low_water_mark,
+                           [](const Socket &client, size_t, TcpServer *const server) {
+                               CoConnection::State *state = stateOf(server, client);
+                               if (state != nullptr) {
+                                   state->blocked = true;
+                               }
+                           },
+                           [](const Socket &client, size_t, TcpServer *const server) {
+                               CoConnection::State *state = stateOf(server, client);
+                               if (state != nullptr) {
+                                   state->blocked = false;
+                                   wake(state->writer);
+                               }
+                           });
+}
+
+void CoServer::onConnect(const Socket &client) {
+    auto state = make_shared<CoConnection::State>(server_, client);
+    server_->setContext(client, make_shared<Attachment>(state));
+    handler_(CoConnection(std::move(state)));
+}
+
+void CoServer::onMessage(const Socket &client, const char *data, size_t len) {
+    CoConnection::State *state = stateOf(server_, client);
+    if (state == nullptr) {
+        return;
+    }
+    state->messages.emplace_back(data, len);
+    wake(state->reader);
+}
+
+#endif // CW_COROUTINE
@@ -0,0 +1,264 @@
+#pragma once
+
+#ifdef CW_COROUTINE
+
+#include "TcpServer.h"
+#include <coroutine>
+#include <exception>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace CwNetWork {
+
+    /*
+     * 连接处理协程的返回类型
+     * 协程创建后立即运行到第一个挂起点，此后只由所属事件循环恢复，运行结束时自行销毁
+     */
+    class CoTask {
+
+    public:
+
+        struct promise_type {
+            CoTask get_return_object() noexcept { return {}; }
+
+            std::suspend_never initial_suspend() noexcept { return {}; }
+
+            std::suspend_never final_suspend() noexcept { return {}; }
+
+            void return_void() noexcept {}
+
+            // 与回调函数中抛出异常一样终止进程
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+
+    };
+
+    /*
+     * 协程中使用的连接句柄，可复制，全部副本共享同一个连接状态
+     * 只能在连接所属的事件循环线程中(即处理协程内)使用；连接断开后read返回空串、write返回false
+     */
+    class CoConnection {
+
+    public:
+
+        // 连接状态，只由所属事件循环线程访问
+        struct State {
+            State(TcpServer *server, const Socket &client) : server(server), client(client) {}
+
+            // 所属的Tcp服务端
+            TcpServer *server;
+            // 客户端Socket
+            Socket client;
+            // 尚未被读取的消息，每个元素为接收回调交付的一次数据
+            std::deque<std::string> messages;
+            // 连接是否已断开
+            bool closed = false;
+            // 发送缓冲区是否越过了高水位
+            bool blocked = false;
+            // 等待数据的协程
+            std::coroutine_handle<> reader;
+            // 等待发送缓冲区回落的协程
+            std::coroutine_handle<> writer;
+        };
+
+        /*
+         * co_await read()/readFrame()的等待体，结果为读到的数据，连接已断开且没有剩余数据时为空串
+         */
+        class ReadAwaiter {
+
+        public:
+
+            ReadAwaiter(State *state, bool frame) : state_(state), frame_(frame) {}
+
+            bool await_ready() const noexcept { return !state_->messages.empty() || state_->closed; }
+
+            void await_suspend(std::coroutine_handle<> handle) noexcept { state_->reader = handle; }
+
+            std::string await_resume();
+
+        private:
+
+            // 连接状态
+            State *state_;
+            // 是否只取一条消息
+            bool frame_;
+
+        };
+
+        /*
+         * co_await write()的等待体，发送缓冲区越过高水位时挂起到回落至低水位，结果为数据是否已写入发送缓冲区且连接未断开
+         */
+        class WriteAwaiter {
+
+        public:
+
+            WriteAwaiter(State *state, bool sent) : state_(state), sent_(sent) {}
+
+            bool await_ready() const noexcept { return !sent_ || !state_->blocked || state_->closed; }
+
+            void await_suspend(std::coroutine_handle<> handle) noexcept { state_->writer = handle; }
+
+            bool await_resume() const noexcept { return sent_ && !state_->closed; }
+
+        private:
+
+            // 连接状态
+            State *state_;
+            // 数据是否已写入发送缓冲区
+            bool sent_;
+
+        };
+
+        explicit CoConnection(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+        /**
+          * @brief  读取已到达的全部数据，没有数据时挂起到数据到达或连接断开
+          * @retval 等待体，co_await的结果为读到的数据
+          */
+        ReadAwaiter read() { return ReadAwaiter(state_.get(), false); }
+
+        /**
+          * @brief  读取一条消息，没有消息时挂起到消息到达或连接断开
+          * @note   每条消息为接收回调的一次交付，TcpServer设置了编解码器时即为一帧
+          * @retval 等待体，co_await的结果为读到的消息
+          */
+        ReadAwaiter readFrame() { return ReadAwaiter(state_.get(), true); }
+
+        /**
+          * @brief  发送数据
+          * @note   调用时即写入发送缓冲区，无需co_await也会发送；co_await时如果越过了高水位则挂起到回落至低水位
+          * @param  要发送的数据
+          * @retval 等待体，co_await的结果为是否发送成功
+          */
+        WriteAwaiter write(const std::string &);
+
+        /**
+          * @brief  使用TcpServer的编解码器将消息编码为一帧后发送
+          * @note   消息无法编码为一帧时抛出编解码器的异常
+          * @param  要发送的消息
+          * @retval 等待体，co_await的结果为是否发送成功
+          */
+        WriteAwaiter writeFrame(const std::string &);
+
+        /**
+          * @brief  断开连接，之后的read立即返回剩余数据或空串
+          */
+        void close();
+
+        /**
+          * @brief  判断连接是否已断开
+          * @retval 是否已断开
+          */
+        bool closed() const { return state_->closed; }
+
+        /**
+          * @brief  获取客户端Socket
+          * @retval Socket
+          */
+        const Socket &getSocket() const { return state_->client; }
+
+        /**
+          * @brief  获取所属的Tcp服务端
+          * @retval TcpServer指针
+          */
+        TcpServer *getTcpServer() const { return state_->server; }
+
+    private:
+
+        // 连接状态
+        std::shared_ptr<State> state_;
+
+    };
+
+    /*
+     * co_await sleep(ms)的等待体，由当前事件循环在到期后恢复协程
+     */
+    class SleepAwaiter {
+
+    public:
+
+        explicit SleepAwaiter(int delay_ms) : delay_ms_(delay_ms) {}
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<>);
+
+        void await_resume() const noexcept {}
+
+    private:
+
+        // 延迟毫秒数
+        int delay_ms_;
+
+    };
+
+    /**
+      * @brief  挂起当前协程指定的毫秒数，期间事件循环继续处理其他连接
+      * @note   只能在事件循环线程中co_await，否则抛出std::runtime_error异常；事件循环退出时仍在等待的协程被直接销毁。
+      *         0毫秒时让出到事件循环的下一轮
+      * @param  毫秒数
+      * @retval 等待体
+      */
+    inline SleepAwaiter sleep(int delay_ms) { return SleepAwaiter(delay_ms); }
+
+    /*
+     * 基于TcpServer的协程层，为每个新连接启动一个处理协程，以co_await顺序编写有状态的协议而无需回调和全局状态表
+     * 协程运行在连接所属的事件循环线程中，由该事件循环在数据到达、发送缓冲区回落或定时到期时恢复。
+     * 接管TcpServer的连接建立回调和消息回调，连接状态保存在连接上下文中；热升级接管的连接不启动协程，其数据被丢弃
+     */
+    class CoServer {
+
+    public:
+
+        // 连接处理函数，返回的协程处理该连接的全部交互
+        using Handler = std::function<CoTask(CoConnection)>;
+
+        /**
+          * @brief  在Tcp服务端上安装协程层
+          * @note   必须在run之前构造，且在服务端运行期间保持存活；协程lambda应通过参数而非捕获获取每个连接的数据
+          * @param  _1:Tcp服务端 _2:连接处理函数
+          */
+        CoServer(TcpServer *, Handler);
+
+        CoServer(const CoServer &) = delete;
+
+        CoServer &operator=(const CoServer &) = delete;
+
+        /**
+          * @brief  设置发送缓冲区高低水位，co_await write在越过高水位时挂起到回落至低水位
+          * @note   替代TcpServer::setWaterMarks的回调；未设置时write从不挂起。必须在run之前设置
+          * @param  _1:高水位字节数 _2:低水位字节数
+          */
+        void setWaterMarks(size_t, size_t);
+
+        /**
+          * @brief  获取Tcp服务端
+          * @retval TcpServer指针
+          */
+        TcpServer *getTcpServer() const { return server_; }
+
+    private:
+
+        /**
+          * @brief  为新连接创建状态并启动处理协程
+          * @param  客户端Socket
+          */
+        void onConnect(const Socket &);
+
+        /**
+          * @brief  保存收到的消息并恢复等待数据的协程
+          * @param  _1:客户端Socket _2:消息起始地址 _3:消息长度
+          */
+        void onMessage(const Socket &, const char *, size_t);
+
+        // Tcp服务端
+        TcpServer *server_;
+        // 连接处理函数
+        Handler handler_;
+
+    };
+
+}
+
+#endif // CW_COROUTINE
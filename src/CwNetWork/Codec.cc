@@ -0,0 +1,140 @@
+#include "Codec.h"
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+using namespace std;
+using namespace CwNetWork;
+
+// varint长度字段最多占用的字节数
+static const size_t kMaxVarintLen = 10;
+
+ssize_t LengthFieldCodec::decode(const char *data, size_t len, const char **frame, size_t *frame_len) const {
+    auto bytes = reinterpret_cast<const unsigned char *>(data);
+    uint64_t body_len = 0;
+    size_t header_len = 0;
+    switch (field_) {
+        case LengthField::UINT8:
+            header_len = 1;
+            break;
+        case LengthField::UINT16:
+            header_len = 2;
+            break;
+        case LengthField::UINT32:
+            header_len = 4;
+            break;
+        case LengthField::VARINT:
+            for (size_t i = 0;; ++i) {
+                if (i == len) {
+                    return 0;
+                }
+                if (i == kMaxVarintLen) {
+                    return -1;
+                }
+                body_len |= static_cast<uint64_t>(bytes[i] & 0x7f) << (7 * i);
+                if ((bytes[i] & 0x80) == 0) {
+                    header_len = i + 1;
+                    break;
+                }
+            }
+            break;
+    }
+    if (len < header_len) {
+        return 0;
+    }
+    if (field_ != LengthField::VARINT) {
+        for (size_t i = 0; i < header_len; ++i) {
+            body_len = (body_len << 8) | bytes[i];
+        }
+    }
+    if (body_len > max_frame_len_) {
+        return -1;
+    }
+    if (len - header_len < body_len) {
+        return 0;
+    }
+    *frame = data + header_len;
+    *frame_len = body_len;
+    return header_len + body_len;
+}
+
+string LengthFieldCodec::encode(const string &message) const {
+    uint64_t body_len = message.size();
+    uint64_t field_max = field_ == LengthField::UINT8 ? 0xff :
+                         field_ == LengthField::UINT16 ? 0xffff :
+                         field_ == LengthField::UINT32 ? 0xffffffff : UINT64_MAX;
+    // 超出长度字段表示范围的长度会被截断，超出最大消息长度的帧会被对端当作违反协议
+    if (body_len > field_max || body_len > max_frame_len_) {
+        throw length_error("the message is too long for the length field codec");
+    }
+    string frame;
+    switch (field_) {
+        case LengthField::UINT8:
+            frame.push_back(static_cast<char>(body_len));
+            break;
+        case LengthField::UINT16:
+            frame.push_back(static_cast<char>(body_len >> 8));
+            frame.push_back(static_cast<char>(body_len));
+            break;
+        case LengthField::UINT32:
+            frame.push_back(static_cast<char>(body_len >> 24));
+            frame.push_back(static_cast<char>(body_len >> 16));
+            frame.push_back(static_cast<char>(body_len >> 8));
+            frame.push_back(static_cast<char>(body_len));
+            break;
+        case LengthField::VARINT:
+            while (body_len >= 0x80) {
+                frame.push_back(static_cast<char>((body_len & 0x7f) | 0x80));
+                body_len >>= 7;
+            }
+            frame.push_back(static_cast<char>(body_len));
+            break;
+    }
+    frame.append(message);
+    return frame;
+}
+
+ssize_t DelimiterCodec::decode(const char *data, size_t len, const char **frame, size_t *frame_len) const {
+    auto pos = static_cast<const char *>(memmem(data, len, delimiter_.data(), delimiter_.size()));
+    if (pos == nullptr) {
+        return len > max_frame_len_ + delimiter_.size() ? -1 : 0;
+    }
+    if (static_cast<size_t>(pos - data) > max_frame_len_) {
+        return -1;
+    }
+    *frame = data;
+    *frame_len = pos - data;
+    return *frame_len + delimiter_.size();
+}
+
+string DelimiterCodec::encode(const string &message) const {
+    if (message.size() > max_frame_len_) {
+        throw length_error("the message is too long for the delimiter codec");
+    }
+    string frame;
+    frame.reserve(message.size() + delimiter_.size());
+    frame.append(message).append(delimiter_);
+    // 对端在第一个分隔符处分帧，消息含有分隔符或其结尾与分隔符拼出分隔符时都会被拆开
+    if (frame.find(delimiter_) != message.size()) {
+        throw length_error("the message contains the delimiter of the delimiter codec");
+    }
+    return frame;
+}
+
+ssize_t FixedLengthCodec::decode(const char *data, size_t len, const char **frame, size_t *frame_len) const {
+    if (len < frame_len_) {
+        return 0;
+    }
+    *frame = data;
+    *frame_len = frame_len_;
+    return frame_len_;
+}
+
+string FixedLengthCodec::encode(const string &message) const {
+    if (message.size() > frame_len_) {
+        throw length_error("the message is too long for the fixed length codec");
+    }
+    string frame = message;
+    frame.resize(frame_len_, '\0');
+    return frame;
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <sys/types.h>
+
+namespace CwNetWork {
+
+    /*
+     * 消息分帧编解码器，负责从字节流中切分出完整消息以及为发送的消息加上帧格式
+     * 编解码器不保存连接状态，可被多个事件循环和连接共享
+     */
+    class Codec {
+
+    public:
+
+        virtual ~Codec() = default;
+
+        /**
+          * @brief  从接收到的字节流头部解析一帧消息
+          * @note   帧内容指向传入的数据，不发生复制
+          * @param  _1:数据起始地址 _2:数据长度 _3:帧内容起始地址 _4:帧内容长度
+          * @retval 该帧在字节流中占用的字节数；数据不足一帧返回0；违反协议返回-1
+          */
+        virtual ssize_t decode(const char *, size_t, const char **, size_t *) const = 0;
+
+        /**
+          * @brief  将一条消息编码为一帧
+          * @param  消息内容
+          * @retval 编码后的帧
+          */
+        virtual std::string encode(const std::string &) const = 0;
+
+    };
+
+    /*
+     * 长度字段的编码方式，定长长度字段均为网络字节序
+     */
+    enum class LengthField {
+        UINT8, UINT16, UINT32, VARINT
+    };
+
+    /*
+     * 长度前缀分帧: [长度字段][消息内容]，长度不包含长度字段本身
+     */
+    class LengthFieldCodec : public Codec {
+
+    public:
+
+        /**
+          * @brief  构造一个长度前缀编解码器
+          * @param  _1:长度字段的编码方式 _2:允许的最大消息长度，超出视为违反协议
+          */
+        explicit LengthFieldCodec(LengthField field = LengthField::UINT32, size_t max_frame_len = 1 << 20)
+                : field_(field), max_frame_len_(max_frame_len) {}
+
+        ssize_t decode(const char *, size_t, const char **, size_t *) const override;
+
+        /**
+          * @brief  将一条消息编码为一帧
+          * @note   消息长度超出长度字段的表示范围或最大消息长度时抛出std::length_error异常
+          * @param  消息内容
+          * @retval 编码后的帧
+          */
+        std::string encode(const std::string &) const override;
+
+    private:
+
+        // 长度字段的编码方式
+        LengthField field_;
+        // 允许的最大消息长度
+        size_t max_frame_len_;
+
+    };
+
+    /*
+     * 分隔符分帧: [消息内容][分隔符]，交给回调的消息不包含分隔符
+     */
+    class DelimiterCodec : public Codec {
+
+    public:
+
+        /**
+          * @brief  构造一个分隔符编解码器
+          * @param  _1:分隔符，不能为空 _2:允许的最大消息长度，超出仍未找到分隔符视为违反协议
+          */
+        explicit DelimiterCodec(std::string delimiter = "\n", size_t max_frame_len = 1 << 16)
+                : delimiter_(std::move(delimiter)), max_frame_len_(max_frame_len) {}
+
+        ssize_t decode(const char *, size_t, const char **, size_t *) const override;
+
+        /**
+          * @brief  将一条消息编码为一帧
+          * @note   消息长度超出最大消息长度，或消息含有分隔符(包括结尾与分隔符拼出分隔符)时对端无法还原该消息，
+          *         抛出std::length_error异常
+          * @param  消息内容
+          * @retval 编码后的帧
+          */
+        std::string encode(const std::string &) const override;
+
+    private:
+
+        // 分隔符
+        std::string delimiter_;
+        // 允许的最大消息长度
+        size_t max_frame_len_;
+
+    };
+
+    /*
+     * 定长分帧: 每条消息均为固定长度
+     */
+    class FixedLengthCodec : public Codec {
+
+    public:
+
+        /**
+          * @brief  构造一个定长编解码器
+          * @param  每条消息的长度，必须大于0
+          */
+        explicit FixedLengthCodec(size_t frame_len) : frame_len_(frame_len) {}
+
+        ssize_t decode(const char *, size_t, const char **, size_t *) const override;
+
+        /**
+          * @brief  将一条消息编码为一帧
+          * @note   消息长度不足时以'\0'补齐到固定长度，对端收到的消息包含补齐的'\0'；
+          *         超出固定长度时抛出std::length_error异常
+          * @param  消息内容
+          * @retval 编码后的帧
+          */
+        std::string encode(const std::string &) const override;
+
+    private:
+
+        // 每条消息的长度
+        size_t frame_len_;
+
+    };
+
+}
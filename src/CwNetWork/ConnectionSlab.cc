@@ -0,0 +1,44 @@
+#include "ConnectionSlab.h"
+
+using namespace std;
+using namespace CwNetWork;
+
+ConnectionSlab::ConnectionSlab(size_t capacity) {
+    page_num_ = (capacity + kPageSize - 1) / kPageSize;
+    capacity_ = page_num_ * kPageSize;
+    pages_.reset(new atomic<Connection *>[page_num_]);
+    for (size_t i = 0; i < page_num_; ++i) {
+        pages_[i].store(nullptr, memory_order_relaxed);
+    }
+}
+
+ConnectionSlab::~ConnectionSlab() {
+    for (size_t i = 0; i < page_num_; ++i) {
+        delete[]pages_[i].load(memory_order_relaxed);
+    }
+}
+
+Connection *ConnectionSlab::acquire(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= capacity_) {
+        return nullptr;
+    }
+    atomic<Connection *> &page = pages_[fd / kPageSize];
+    Connection *slots = page.load(memory_order_acquire);
+    if (slots == nullptr) {
+        Connection *fresh = new Connection[kPageSize];
+        if (page.compare_exchange_strong(slots, fresh, memory_order_acq_rel)) {
+            slots = fresh;
+        } else {
+            delete[]fresh;
+        }
+    }
+    return &slots[fd % kPageSize];
+}
+
+Connection *ConnectionSlab::get(int fd) const {
+    if (fd < 0 || static_cast<size_t>(fd) >= capacity_) {
+        return nullptr;
+    }
+    Connection *slots = pages_[fd / kPageSize].load(memory_order_acquire);
+    return slots == nullptr ? nullptr : &slots[fd % kPageSize];
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "AddrInfo.h"
+#include "OutputBuffer.h"
+#include "Buffer.h"
+#include "TimingWheel.h"
+#include <string>
+#include <atomic>
+#include <memory>
+
+namespace CwNetWork {
+
+    class EventLoop;
+
+    class TcpClient;
+
+    /*
+     * 一个客户端连接的全部状态，存放于以文件描述符为下标的连接槽中
+     * loop、generation与session可被其他线程读取，其余成员只允许所属事件循环线程访问
+     */
+    struct Connection {
+        // 客户端套接字描述符
+        int fd = -1;
+        // 在所属事件循环连接列表中的下标
+        size_t index = 0;
+        // 所属的事件循环，空闲槽为nullptr
+        std::atomic<EventLoop *> loop{nullptr};
+        // 槽位代数，每次释放时自增，用于识别文件描述符被复用后的旧连接
+        std::atomic<uint32_t> generation{0};
+        // 会话随机数，与文件描述符一起组成会话标识，空闲槽为0
+        std::atomic<uint32_t> session{0};
+        // 对端网络地址
+        AddrInfo addr_info;
+        // 空闲超时定时器节点
+        TimerNode idle_timer;
+        // 最近一次收到数据时时间轮的刻度
+        uint64_t last_active = 0;
+        // 写停滞定时器节点，发送缓冲区非空时挂入时间轮
+        TimerNode stall_timer;
+        // 最近一次有数据被写入内核时时间轮的刻度
+        uint64_t last_progress = 0;
+        // 接收缓冲区
+        Buffer input;
+        // 发送缓冲区
+        OutputBuffer output;
+        // 当前在Poller上注册的事件
+        uint32_t events = 0;
+        // 发送缓冲区是否越过了高水位且尚未回落到低水位
+        bool backed_up = false;
+        // 排空时是否已经shutdown(SHUT_WR)关闭了写方向
+        bool write_closed = false;
+        // 使用者通过TcpServer::setContext保存的上下文，断开时释放
+        std::shared_ptr<void> context;
+        // 发起该连接的Tcp客户端，由accept得到的连接为nullptr
+        TcpClient *client = nullptr;
+        // 主动连接是否仍在等待握手完成
+        bool connecting = false;
+        // 是否由Poller的recv请求交付数据、以发送请求写出内存数据块(完成模型)
+        bool completion = false;
+        // 是否有已提交、尚未结束的发送请求，期间发送缓冲区头部的数据块不能被丢弃
+        bool sending = false;
+    };
+
+    class ConnectionSlab {
+
+    public:
+
+        /**
+          * @brief  构造一个以文件描述符为下标的连接槽
+          * @note   连接槽按页分配，每页为一段连续的Connection数组，首次使用时才分配
+          * @param  可管理的最大文件描述符数量
+          */
+        explicit ConnectionSlab(size_t);
+
+        ~ConnectionSlab();
+
+        ConnectionSlab(const ConnectionSlab &) = delete;
+
+        ConnectionSlab &operator=(const ConnectionSlab &) = delete;
+
+        /**
+          * @brief  获取指定文件描述符的连接槽，所在页不存在时分配
+          * @note   线程安全，返回的指针在连接槽析构前始终有效
+          * @param  文件描述符
+          * @retval 连接槽指针，文件描述符超出可管理范围时返回nullptr
+          */
+        Connection *acquire(int);
+
+        /**
+          * @brief  获取指定文件描述符的连接槽
+          * @note   线程安全，不会分配新页
+          * @param  文件描述符
+          * @retval 连接槽指针，所在页尚未分配或超出可管理范围时返回nullptr
+          */
+        Connection *get(int) const;
+
+        /**
+          * @brief  获取可管理的最大文件描述符数量
+          * @retval 最大文件描述符数量
+          */
+        size_t capacity() const { return capacity_; }
+
+    private:
+
+        // 每页包含的连接槽数量
+        static const size_t kPageSize = 1024;
+
+        // 可管理的最大文件描述符数量
+        size_t capacity_;
+        // 页表长度
+        size_t page_num_;
+        // 页表，每项指向一段连续的Connection数组
+        std::unique_ptr<std::atomic<Connection *>[]> pages_;
+
+    };
+
+}
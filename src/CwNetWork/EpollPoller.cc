@@ -0,0 +1,42 @@
+#include "EpollPoller.h"
+#include <unistd.h>
+
+using namespace std;
+using namespace CwNetWork;
+
+EpollPoller::EpollPoller(bool edge_triggered, int init_size)
+        : Poller(init_size), fd_(epoll_create1(EPOLL_CLOEXEC)), edge_triggered_(edge_triggered) {}
+
+EpollPoller::~EpollPoller() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+bool EpollPoller::add(int fd, uint32_t events, void *ptr) {
+    return control(EPOLL_CTL_ADD, fd, events, ptr);
+}
+
+bool EpollPoller::mod(int fd, uint32_t events, void *ptr) {
+    return control(EPOLL_CTL_MOD, fd, events, ptr);
+}
+
+bool EpollPoller::del(int fd) {
+    return epoll_ctl(fd_, EPOLL_CTL_DEL, fd, nullptr) == 0;
+}
+
+int EpollPoller::wait(int timeout) {
+    int ev_num = epoll_wait(fd_, events_.data(), static_cast<int>(events_.size()), timeout);
+    if (ev_num == static_cast<int>(events_.size())) {
+        // 本次填满说明可能还有就绪事件，扩容后下次一并取回
+        events_.resize(events_.size() * 2);
+    }
+    return ev_num;
+}
+
+bool EpollPoller::control(int op, int fd, uint32_t events, void *ptr) const {
+    struct epoll_event event{};
+    event.events = edge_triggered_ ? events : events & ~static_cast<uint32_t>(EPOLLET);
+    event.data.ptr = ptr;
+    return epoll_ctl(fd_, op, fd, &event) == 0;
+}
@@ -0,0 +1,1389 @@
+#include "EventLoop.h"
+#include "TcpServer.h"
+#include "TcpClient.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <future>
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+using namespace std;
+using namespace CwNetWork;
+
+// 每次服务端套接字可读时最多接受的连接数
+static const int kAcceptBudget = 128;
+
+// 文件描述符耗尽且没有预留描述符时暂停接受的毫秒数
+static const int64_t kShedBackoffMs = 100;
+
+// 排空到期后每轮事件循环最多关闭的连接数，避免一次执行大量关闭回调阻塞事件循环
+static const size_t kDrainCloseBatch = 256;
+
+/**
+  * @brief  为accept请求接受的连接构造Socket对象，对端地址由getpeername取得
+  * @param  新连接的描述符
+  * @retval 客户端Socket对象
+  */
+static Socket acceptedSocket(int fd) {
+    AddrInfo info;
+    socklen_t len = AddrInfo::kMaxSockLen;
+    getpeername(fd, info.getSockAddrPtr(), &len);
+    info.setSockLen(len);
+    return Socket(fd, info);
+}
+
+// 当前线程正在运行的事件循环
+static thread_local EventLoop *t_loop_in_this_thread = nullptr;
+
+EventLoop::EventLoop(TcpServer *server, size_t rbuf_size)
+        : server_(server), slab_(server->slab_.get()), rbuf_size_(rbuf_size) {}
+
+EventLoop::~EventLoop() {
+    for (auto conn: conns_) {
+        close(conn->fd);
+    }
+    for (auto &client: held_) {
+        client.closeFd();
+    }
+    if (server_socket_ != nullptr) {
+        removeListenPath();
+        server_socket_->closeFd();
+    }
+    if (reserve_fd_ != -1) {
+        close(reserve_fd_);
+    }
+    if (wakeup_fd_ != -1) {
+        close(wakeup_fd_);
+    }
+    if (timer_fd_ != -1) {
+        close(timer_fd_);
+    }
+    if (upgrade_fd_ != -1) {
+        close(upgrade_fd_);
+        unlink(upgrade_path_.c_str());
+    }
+}
+
+bool EventLoop::init() {
+    poller_ = Poller::newPoller(server_->io_backend_);
+    if (poller_ == nullptr) {
+        error_ = "failed to create the poller";
+        return false;
+    }
+    completion_ = poller_->completionBased();
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ == -1) {
+        error_ = "failed to create the wakeup eventfd";
+        return false;
+    }
+    if (!poller_->add(wakeup_fd_, EPOLLIN, &wakeup_fd_)) {
+        error_ = "failed to add the wakeup eventfd to the epoll model";
+        return false;
+    }
+    {
+        // 事件循环启动前投递的任务在第一轮执行
+        lock_guard<mutex> lock(pending_mutex_);
+        looping_ = true;
+    }
+    if (!timers_.init() || !poller_->add(timers_.getFd(), EPOLLIN, &timers_)) {
+        error_ = "failed to create the timer queue";
+        return false;
+    }
+    int idle_timeout_ms = server_->idle_timeout_ms_;
+    int stall_timeout_ms = server_->write_stall_timeout_ms_;
+    if ((idle_timeout_ms <= 0 && stall_timeout_ms <= 0) || server_->acceptor_.get() == this) {
+        return true;
+    }
+    // 时间轮精度为较短超时的1%，限制在10毫秒到1秒之间
+    int shortest = idle_timeout_ms <= 0 ? stall_timeout_ms :
+                   stall_timeout_ms <= 0 ? idle_timeout_ms : min(idle_timeout_ms, stall_timeout_ms);
+    tick_ms_ = min(max(shortest / 100, 10), 1000);
+    if (idle_timeout_ms > 0) {
+        idle_ticks_ = (idle_timeout_ms + tick_ms_ - 1) / tick_ms_;
+    }
+    if (stall_timeout_ms > 0) {
+        stall_ticks_ = (stall_timeout_ms + tick_ms_ - 1) / tick_ms_;
+    }
+    wheel_.reset(new TimingWheel(currentTick()));
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ == -1) {
+        error_ = "failed to create the timerfd";
+        return false;
+    }
+    struct itimerspec spec{};
+    spec.it_interval.tv_sec = tick_ms_ / 1000;
+    spec.it_interval.tv_nsec = (tick_ms_ % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(timer_fd_, 0, &spec, nullptr) == -1 || !poller_->add(timer_fd_, EPOLLIN, &timer_fd_)) {
+        error_ = "failed to add the timerfd to the epoll model";
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::listen(const AddrInfo &addr, int type, int backlog, bool reuse_port) {
+    int inherited_fd = server_->takeInheritedListener();
+    if (inherited_fd != -1) {
+        // 继承的服务端套接字已处于监听状态，等待队列中的连接不会丢失
+        server_socket_.reset(new ServerSocket(ServerSocket::fromFd(inherited_fd)));
+        return registerListener();
+    }
+    server_socket_.reset(new ServerSocket(ServerSocket::newServerSocket(addr.getFamily(), type)));
+    if (server_socket_->getFd() == -1) {
+        error_ = "failed to create the server-side socket";
+        return false;
+    }
+    if (!server_socket_->setSockReuable()) {
+        error_ = "the port multiplexing setting failed";
+        return false;
+    }
+    if (reuse_port && !server_socket_->setReusePort()) {
+        error_ = "the SO_REUSEPORT setting failed";
+        return false;
+    }
+    if (!server_socket_->serverBind(addr)) {
+        error_ = "failed to bind " + addr.toString();
+        return false;
+    }
+    string option;
+    if (!server_->socket_options_.applyTo(*server_socket_, option)) {
+        error_ = "failed to set the socket option " + option;
+        return false;
+    }
+    if (!server_socket_->serverListen(backlog)) {
+        error_ = "listening failed";
+        return false;
+    }
+    return registerListener();
+}
+
+bool EventLoop::registerListener() {
+    server_socket_->setNonBlock();
+    reserve_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    listen_fd_ = server_socket_->getFd();
+    if (!watchListener()) {
+        listen_fd_ = -1;
+        error_ = "failed to add server-side sockets to the epoll model";
+        return false;
+    }
+    listen_loops_ = server_->accept_mode_ == AcceptMode::REUSE_PORT ? static_cast<double>(server_->loop_num_) : 1;
+    return true;
+}
+
+bool EventLoop::listenUpgrade(const string &path) {
+    upgrade_fd_ = UpgradeChannel::listen(path);
+    if (upgrade_fd_ == -1) {
+        error_ = "failed to listen on the upgrade socket";
+        return false;
+    }
+    upgrade_path_ = path;
+    if (!poller_->add(upgrade_fd_, EPOLLIN, &upgrade_fd_)) {
+        error_ = "failed to add the upgrade socket to the epoll model";
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::handOver(vector<int> &listen_fds, vector<HandoffConnection> &conns) {
+    if (server_socket_ != nullptr) {
+        if (!accept_paused_.load(memory_order_relaxed)) {
+            unwatchListener();
+        }
+        listen_fds.push_back(listen_fd_);
+    }
+    conns.reserve(conns.size() + conns_.size() + held_.size());
+    // accept请求已接受但尚未处理的连接一并移交；移交失败时仍留待恢复接受时处理
+    for (const Socket &client: held_) {
+        HandoffConnection handoff;
+        handoff.fd = client.getFd();
+        handoff.addr_info = client.addr_info;
+        conns.push_back(std::move(handoff));
+    }
+    for (Connection *conn: conns_) {
+        if (wheel_ != nullptr) {
+            wheel_->remove(&conn->idle_timer);
+            wheel_->remove(&conn->stall_timer);
+        }
+        // 完成模型下先取回已读出的数据和发送请求的结果，导出的缓冲区与套接字中的数据衔接
+        settle(conn);
+        HandoffConnection handoff;
+        handoff.fd = conn->fd;
+        handoff.addr_info = conn->addr_info;
+        handoff.input.assign(conn->input.peek(), conn->input.readableBytes());
+        conn->output.forEach([&handoff](const OutputBuffer::Chunk &chunk, size_t offset, size_t remain, int fd,
+                                        bool pipe) {
+            // 相邻的内存数据块合并为一段
+            if (fd == -1 && !handoff.output.empty() && handoff.output.back().fd == -1) {
+                handoff.output.back().data.append(chunk->data() + offset, remain);
+                return;
+            }
+            HandoffSegment segment;
+            if (fd == -1) {
+                segment.data.assign(chunk->data() + offset, remain);
+            } else {
+                segment.fd = fd;
+                segment.pipe = pipe;
+                segment.offset = static_cast<off_t>(offset);
+                segment.len = remain;
+            }
+            handoff.output.push_back(std::move(segment));
+        });
+        if (server_->upgrade_save_cb_ != nullptr) {
+            handoff.state = server_->upgrade_save_cb_(Socket(conn->fd, conn->addr_info), server_);
+        }
+        conns.push_back(std::move(handoff));
+    }
+    handed_over_ = true;
+}
+
+void EventLoop::resume() {
+    if (!handed_over_) {
+        return;
+    }
+    handed_over_ = false;
+    if (server_socket_ != nullptr && !accept_paused_.load(memory_order_relaxed)) {
+        watchListener();
+    }
+    for (Connection *conn: conns_) {
+        watch(conn);
+        if (idle_ticks_ > 0) {
+            conn->last_active = wheel_->now();
+            wheel_->add(&conn->idle_timer, conn->last_active + idle_ticks_);
+        }
+        // 写停滞定时器按当前时间重新挂入
+        updateOutput(conn);
+    }
+    if (!held_.empty() && !accept_paused_.load(memory_order_relaxed)) {
+        acceptHeld();
+        finishAccept();
+    }
+}
+
+bool EventLoop::adoptClient(HandoffConnection &handoff) {
+    conn_count_.fetch_add(1, memory_order_relaxed);
+    Socket client(handoff.fd, handoff.addr_info);
+    addClient(client, false);
+    Connection *conn = getClient(handoff.fd);
+    if (conn == nullptr) {
+        for (auto &segment: handoff.output) {
+            if (segment.fd != -1) {
+                close(segment.fd);
+            }
+        }
+        return false;
+    }
+    conn->output.setZeroCopyThreshold(0);
+    conn->output.setPacketMode(server_->socket_type_ == SOCK_SEQPACKET);
+    if (!handoff.input.empty()) {
+        conn->input.append(handoff.input.data(), handoff.input.size());
+    }
+    for (auto &segment: handoff.output) {
+        if (segment.fd == -1) {
+            conn->output.append(segment.data.data(), segment.data.size());
+        } else if (segment.pipe) {
+            conn->output.appendPipe(segment.fd, segment.len);
+        } else {
+            conn->output.appendFile(segment.fd, segment.offset, segment.len);
+        }
+    }
+    updateOutput(conn);
+    return true;
+}
+
+void EventLoop::loop() {
+    t_loop_in_this_thread = this;
+    int ev_num = 0, i = 0;
+    void *ptr = nullptr;
+    bool accepted = false;
+    doPendingFunctors();
+    while (!quit_.load(memory_order_acquire)) {
+        ev_num = poller_->wait(pollTimeout());
+        accepted = false;
+        // 分发前记录各连接的槽位代数，本轮中已被前面的回调关闭(或关闭后被复用)的连接的事件将被跳过
+        if (generations_.size() < static_cast<size_t>(ev_num)) {
+            generations_.resize(ev_num);
+        }
+        for (i = 0; i < ev_num; ++i) {
+            ptr = (*poller_)[i].data.ptr;
+            if (!isControl(ptr)) {
+                generations_[i] = static_cast<Connection *>(ptr)->generation.load(memory_order_relaxed);
+            }
+        }
+        for (i = 0; i < ev_num; ++i) {
+            ptr = (*poller_)[i].data.ptr;
+            if (ptr == &listen_fd_ && accept_completion_) {
+                handleAccepted(poller_->result(i).res);
+                accepted = true;
+            } else if (ptr == &listen_fd_) {
+                handleAccept();
+            } else if (ptr == &wakeup_fd_) {
+                handleWakeup();
+            } else if (ptr == &timer_fd_) {
+                handleTimer();
+            } else if (ptr == &timers_) {
+                timers_.handleRead();
+            } else if (ptr == &upgrade_fd_) {
+                handleUpgrade();
+            } else {
+                auto conn = static_cast<Connection *>(ptr);
+                uint32_t generation = generations_[i];
+                if (!owns(conn, generation)) {
+                    continue;
+                }
+                if (conn->connecting) {
+                    handleConnect(conn);
+                    continue;
+                }
+                uint32_t events = (*poller_)[i].events;
+                if (conn->completion) {
+                    const Poller::Result &result = poller_->result(i);
+                    if (result.type == Poller::Completion::RECV) {
+                        handleReceived(conn, result.data, result.res);
+                    } else if (result.type == Poller::Completion::SEND) {
+                        handleSent(conn, result.res);
+                    } else if ((events & (EPOLLERR | EPOLLHUP)) && !(conn->events & EPOLLIN)) {
+                        // 对端关闭和出错由recv请求报告；暂停读取时没有recv请求，在这里关闭
+                        closeClient(conn);
+                    } else if (events & EPOLLOUT) {
+                        handleWrite(conn);
+                    }
+                    continue;
+                }
+                // 零拷贝完成通知也以错误事件报告，取走后不再当作连接出错
+                if ((events & EPOLLERR) && conn->output.reapZeroCopy(conn->fd)) {
+                    events &= ~static_cast<uint32_t>(EPOLLERR);
+                }
+                // 错误和挂断也交给读处理，由读取的结果决定是否关闭连接；暂停读取的连接忽略可读事件
+                if ((events & (EPOLLERR | EPOLLHUP)) || ((events & EPOLLIN) && (conn->events & EPOLLIN))) {
+                    handleRead(conn);
+                }
+                if ((events & EPOLLOUT) && owns(conn, generation)) {
+                    handleWrite(conn);
+                }
+            }
+        }
+        if (accepted) {
+            finishAccept();
+        }
+        doPendingFunctors();
+        if (accept_resume_at_ != 0 && TimerQueue::now() >= accept_resume_at_) {
+            resumeAccept();
+        }
+        if (draining_ || drain_deadline_.load(memory_order_acquire) != 0) {
+            updateDrain();
+        }
+    }
+    // 已投递但尚未注册的连接也在这里一并关闭；任务队列清空后才停止接收任务，之后的同步查询由调用方直接执行
+    while (true) {
+        doPendingFunctors();
+        while (!conns_.empty()) {
+            if (handed_over_) {
+                // 连接已由新进程接管，只关闭本进程持有的描述符；先丢弃发送缓冲区，避免以RST关闭共享的套接字
+                conns_.back()->output.clear();
+                disConnect(conns_.back());
+            } else {
+                closeClient(conns_.back());
+            }
+        }
+        // 主动连接的重连只由定时器发起，事件循环退出后不会再执行
+        while (!outbound_.empty()) {
+            closeClient(outbound_.back());
+        }
+        lock_guard<mutex> lock(pending_mutex_);
+        if (pending_functors_.empty()) {
+            looping_ = false;
+            break;
+        }
+    }
+}
+
+bool EventLoop::isControl(const void *ptr) const {
+    return ptr == &listen_fd_ || ptr == &wakeup_fd_ || ptr == &timer_fd_ || ptr == &timers_ || ptr == &upgrade_fd_;
+}
+
+void EventLoop::quit() {
+    quit_.store(true, memory_order_release);
+    wakeup();
+}
+
+void EventLoop::drain(int timeout_ms) {
+    int64_t deadline = TimerQueue::now() + max(timeout_ms, 0);
+    int64_t expected = 0;
+    if (!drain_deadline_.compare_exchange_strong(expected, deadline, memory_order_acq_rel)) {
+        return;
+    }
+    wakeup();
+}
+
+void EventLoop::updateDrain() {
+    if (!draining_) {
+        draining_ = true;
+        if (server_socket_ != nullptr) {
+            // 关闭服务端套接字，等待队列中尚未接受的连接由内核重置
+            if (accept_paused_.exchange(false, memory_order_acq_rel)) {
+                server_->paused_acceptors_.fetch_sub(1, memory_order_acq_rel);
+            }
+            accept_resume_at_ = 0;
+            unwatchListener();
+            // accept请求已接受但尚未处理的连接同样关闭
+            for (auto &client: held_) {
+                client.closeFd();
+            }
+            held_.clear();
+            removeListenPath();
+            server_socket_->closeFd();
+            server_socket_.reset();
+            listen_fd_ = -1;
+        }
+        for (Connection *conn: conns_) {
+            if (conn->output.empty()) {
+                closeOutput(conn);
+            }
+        }
+    }
+    if (drainTimeout() == 0) {
+        for (size_t i = 0; i < kDrainCloseBatch && !conns_.empty(); ++i) {
+            closeClient(conns_.back());
+        }
+    }
+    // 计数包含已投递但尚未注册的连接，它们注册后同样会被排空
+    if (conn_count_.load(memory_order_acquire) == 0) {
+        quit_.store(true, memory_order_release);
+    }
+}
+
+void EventLoop::closeOutput(Connection *conn) {
+    if (conn->write_closed) {
+        return;
+    }
+    conn->write_closed = true;
+    shutdown(conn->fd, SHUT_WR);
+    uint32_t events = interestOf(conn);
+    if (events != conn->events) {
+        conn->events = events;
+        poller_->mod(conn->fd, events, conn);
+    }
+}
+
+int EventLoop::pollTimeout() const {
+    int64_t timeout = draining_ ? drainTimeout() : -1;
+    if (accept_resume_at_ != 0) {
+        int64_t remain = max<int64_t>(accept_resume_at_ - TimerQueue::now(), 0);
+        timeout = timeout == -1 ? remain : min(timeout, remain);
+    }
+    return static_cast<int>(min<int64_t>(timeout, INT_MAX));
+}
+
+TimerId EventLoop::runAfter(int delay_ms, Functor cb) {
+    shared_ptr<Timer> timer = TimerQueue::newTimer(delay_ms, 0, std::move(cb));
+    TimerId id(timer);
+    addTimer(std::move(timer));
+    return id;
+}
+
+TimerId EventLoop::runEvery(int interval_ms, Functor cb) {
+    interval_ms = max(interval_ms, 1);
+    shared_ptr<Timer> timer = TimerQueue::newTimer(interval_ms, interval_ms, std::move(cb));
+    TimerId id(timer);
+    addTimer(std::move(timer));
+    return id;
+}
+
+void EventLoop::addTimer(shared_ptr<Timer> timer) {
+    if (isInLoopThread()) {
+        timers_.insert(std::move(timer));
+        return;
+    }
+    queueInLoop([this, timer]() {
+        timers_.insert(timer);
+    });
+}
+
+int EventLoop::drainTimeout() const {
+    int64_t remain = drain_deadline_.load(memory_order_acquire) - TimerQueue::now();
+    return remain > 0 ? static_cast<int>(min<int64_t>(remain, INT_MAX)) : 0;
+}
+
+void EventLoop::sendAll(int fd, const string &message) {
+    Connection *conn = getClient(fd);
+    if (conn == nullptr) {
+        throw out_of_range("the client does not belong to this event loop");
+    }
+    sendAll(conn, message);
+}
+
+void EventLoop::sendAll(Connection *conn, const string &message) {
+    size_t sent = 0;
+    size_t zerocopy_threshold = conn->output.zeroCopyThreshold();
+    // 达到零拷贝阈值的消息先复制进缓冲区再发送，直接发送调用方的内存会在函数返回后失效；
+    // 完成模型下也先复制，与本轮的其他发送请求一起在下一次wait时提交
+    if (!conn->completion && conn->output.empty()
+        && (zerocopy_threshold == 0 || message.size() < zerocopy_threshold)) {
+        ssize_t slen = send(conn->fd, message.data(), message.size(), MSG_NOSIGNAL);
+        if (slen > 0) {
+            sent = slen;
+        }
+    }
+    bool idle = conn->output.empty() && sent == 0;
+    conn->output.append(message.data() + sent, message.size() - sent);
+    if (idle) {
+        handleWrite(conn);
+    } else {
+        updateOutput(conn);
+    }
+}
+
+void EventLoop::sendFile(Connection *conn, int file_fd, off_t offset, size_t len) {
+    bool idle = conn->output.empty();
+    conn->output.appendFile(file_fd, offset, len);
+    // 队列原本非空时套接字多半已写满，等待可写事件即可
+    if (idle) {
+        handleWrite(conn);
+    } else {
+        updateOutput(conn);
+    }
+}
+
+void EventLoop::sendPipe(Connection *conn, int pipe_fd, size_t len) {
+    bool idle = conn->output.empty();
+    conn->output.appendPipe(pipe_fd, len);
+    if (idle) {
+        handleWrite(conn);
+    } else {
+        updateOutput(conn);
+    }
+}
+
+void EventLoop::sendChunk(Connection *conn, const OutputBuffer::Chunk &chunk) {
+    bool idle = conn->output.empty();
+    conn->output.append(chunk);
+    if (idle) {
+        handleWrite(conn);
+    } else {
+        updateOutput(conn);
+    }
+}
+
+void EventLoop::broadcast(const OutputBuffer::Chunk &chunk, const vector<Target> &targets) {
+    for (auto &target: targets) {
+        if (owns(target.first, target.second)) {
+            sendChunk(target.first, chunk);
+        }
+    }
+}
+
+void EventLoop::touch(const vector<Target> &targets) {
+    if (wheel_ == nullptr) {
+        return;
+    }
+    for (auto &target: targets) {
+        if (owns(target.first, target.second)) {
+            target.first->last_active = wheel_->now();
+        }
+    }
+}
+
+void EventLoop::broadcast(const OutputBuffer::Chunk &chunk, const function<bool(const Socket &)> &filter) {
+    vector<Target> targets;
+    targets.reserve(conns_.size());
+    for (Connection *conn: conns_) {
+        if (filter == nullptr || filter(Socket(conn->fd, conn->addr_info))) {
+            targets.emplace_back(conn, conn->generation.load(memory_order_relaxed));
+        }
+    }
+    broadcast(chunk, targets);
+}
+
+void EventLoop::disConnect(int client_fd) {
+    Connection *conn = getClient(client_fd);
+    if (conn == nullptr) {
+        throw out_of_range("the client does not belong to this event loop");
+    }
+    disConnect(conn);
+}
+
+void EventLoop::disConnect(Connection *conn) {
+    // 上下文在连接槽复位之后才析构，其析构函数中访问服务端时看到的是已断开的连接
+    shared_ptr<void> context = std::move(conn->context);
+    TcpClient *client = conn->client;
+    vector<Connection *> &list = client != nullptr ? outbound_ : conns_;
+    if (wheel_ != nullptr) {
+        wheel_->remove(&conn->idle_timer);
+        wheel_->remove(&conn->stall_timer);
+    }
+    if (conn->sending) {
+        // 内核可能仍在读取发送请求引用的数据块，等待请求结束后才能释放发送缓冲区
+        settle(conn);
+    } else {
+        poller_->del(conn->fd);
+    }
+    if (conn->output.zeroCopyPending()) {
+        // 内核可能仍引用即将释放的数据块，以RST关闭让内核立即丢弃发送队列，避免重传已被复用的内存
+        struct linger linger{1, 0};
+        setsockopt(conn->fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    }
+    close(conn->fd);
+    Connection *last = list.back();
+    last->index = conn->index;
+    list[conn->index] = last;
+    list.pop_back();
+    conn->input.release();
+    conn->output.clear();
+    conn->fd = -1;
+    conn->client = nullptr;
+    conn->connecting = false;
+    conn->completion = false;
+    conn->session.store(0, memory_order_relaxed);
+    conn->loop.store(nullptr, memory_order_release);
+    conn->generation.fetch_add(1, memory_order_release);
+    if (client != nullptr) {
+        client->handleRelease(conn);
+        return;
+    }
+    conn_count_.fetch_sub(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (server_->paused_acceptors_.load(memory_order_relaxed) > 0) {
+        server_->resumeAccepting();
+    }
+}
+
+unordered_map<int, Socket> EventLoop::getClients() {
+    if (isInLoopThread()) {
+        return collectClients();
+    }
+    auto result = make_shared<promise<unordered_map<int, Socket>>>();
+    future<unordered_map<int, Socket>> clients = result->get_future();
+    {
+        lock_guard<mutex> lock(pending_mutex_);
+        if (!looping_) {
+            return collectClients();
+        }
+        pending_functors_.push_back([this, result]() {
+            result->set_value(collectClients());
+        });
+    }
+    wakeup();
+    return clients.get();
+}
+
+unordered_map<int, Socket> EventLoop::collectClients() const {
+    unordered_map<int, Socket> clients;
+    for (auto conn: conns_) {
+        clients.emplace(conn->fd, Socket(conn->fd, conn->addr_info));
+    }
+    return clients;
+}
+
+void EventLoop::queueConnections(vector<Socket> clients) {
+    conn_count_.fetch_add(clients.size(), memory_order_relaxed);
+    auto batch = make_shared<vector<Socket>>(std::move(clients));
+    queueInLoop([this, batch]() {
+        for (auto &client: *batch) {
+            addClient(client);
+        }
+    });
+}
+
+void EventLoop::runInLoop(Functor cb) {
+    if (isInLoopThread()) {
+        cb();
+    } else {
+        queueInLoop(std::move(cb));
+    }
+}
+
+void EventLoop::queueInLoop(Functor cb) {
+    {
+        lock_guard<mutex> lock(pending_mutex_);
+        pending_functors_.push_back(std::move(cb));
+    }
+    if (!isInLoopThread() || calling_functors_) {
+        wakeup();
+    }
+}
+
+bool EventLoop::isInLoopThread() const {
+    return t_loop_in_this_thread == this;
+}
+
+EventLoop *EventLoop::current() {
+    return t_loop_in_this_thread;
+}
+
+void EventLoop::handleAccept() {
+    bool drained = false;
+    for (int i = 0; i < kAcceptBudget; ++i) {
+        if (!admit()) {
+            pauseAccept();
+            break;
+        }
+        Socket client = server_->acceptClient(*server_socket_);
+        if (client.getFd() == -1) {
+            if (errno == EMFILE || errno == ENFILE) {
+                if (shedConnection()) {
+                    continue;
+                }
+                // 没有预留描述符可用于清出等待队列，水平触发的服务端套接字会立即再次就绪，暂停一段时间再重试
+                accept_resume_at_ = TimerQueue::now() + kShedBackoffMs;
+                pauseAccept();
+                break;
+            } else if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO) {
+                continue;
+            }
+            drained = errno == EAGAIN;
+            break;
+        }
+        dispatchClient(client);
+    }
+    if (drained && completion_ && !accept_completion_ && server_->defaultAccept()) {
+        // accept4先分配描述符，返回EAGAIN说明描述符已不再耗尽，恢复以accept请求接受
+        poller_->del(listen_fd_);
+        watchListener();
+    }
+    finishAccept();
+}
+
+void EventLoop::handleAccepted(int fd) {
+    if (fd == -EMFILE || fd == -ENFILE) {
+        // accept请求先分配描述符再等待连接，描述符耗尽时没有新连接也会立即失败；
+        // 改以可读事件监听，确有连接到来时由handleAccept借助预留描述符清出等待队列
+        unwatchListener();
+        accept_completion_ = false;
+        poller_->add(listen_fd_, EPOLLIN, &listen_fd_);
+        acceptHeld();
+        return;
+    } else if (fd < 0) {
+        // 其他错误(如ECONNABORTED)只影响一个连接，accept请求由Poller重新提交
+        return;
+    }
+    Socket client = acceptedSocket(fd);
+    if (accept_paused_.load(memory_order_relaxed) || !admit()) {
+        held_.push_back(client);
+        pauseAccept();
+        return;
+    }
+    dispatchClient(client);
+}
+
+void EventLoop::acceptHeld() {
+    vector<Socket> held;
+    held.swap(held_);
+    for (size_t i = 0; i < held.size(); ++i) {
+        if (accept_paused_.load(memory_order_relaxed) || !admit()) {
+            // 剩下的连接排在暂停时取回的连接之前
+            held_.insert(held_.begin(), held.begin() + static_cast<ptrdiff_t>(i), held.end());
+            pauseAccept();
+            return;
+        }
+        dispatchClient(held[i]);
+    }
+}
+
+void EventLoop::dispatchClient(const Socket &client) {
+    spendToken();
+    server_->accepted_count_.fetch_add(1, memory_order_relaxed);
+    EventLoop *target = server_->selectLoop(this);
+    if (target == this) {
+        conn_count_.fetch_add(1, memory_order_relaxed);
+        addClient(client);
+        return;
+    }
+    auto batch = find_if(accepted_.begin(), accepted_.end(),
+                         [target](const pair<EventLoop *, vector<Socket>> &item) { return item.first == target; });
+    if (batch == accepted_.end()) {
+        accepted_.emplace_back(target, vector<Socket>());
+        batch = accepted_.end() - 1;
+    }
+    batch->second.push_back(client);
+    ++batched_;
+}
+
+void EventLoop::finishAccept() {
+    for (auto &batch: accepted_) {
+        batch.first->queueConnections(std::move(batch.second));
+    }
+    accepted_.clear();
+    batched_ = 0;
+    if (accept_paused_.load(memory_order_relaxed) && accept_resume_at_ == 0) {
+        // 暂停前后可能已有连接全部关闭而没有看到暂停标志，再检查一次避免永远停在暂停状态
+        atomic_thread_fence(memory_order_seq_cst);
+        if (server_->getConnectionCount() < server_->max_connections_) {
+            resumeAccept();
+        }
+    }
+}
+
+bool EventLoop::admit() {
+    size_t max_connections = server_->max_connections_;
+    if (max_connections > 0 && server_->getConnectionCount() + batched_ >= max_connections) {
+        return false;
+    }
+    double rate = server_->accept_rate_;
+    if (rate <= 0) {
+        return true;
+    }
+    // 令牌桶：速率和容量按监听的事件循环数均分
+    double loop_rate = rate / listen_loops_, burst = max(server_->accept_burst_ / listen_loops_, 1.0);
+    int64_t now = TimerQueue::now();
+    if (tokens_updated_ms_ == 0) {
+        tokens_ = burst;
+    } else {
+        tokens_ = min(burst, tokens_ + (now - tokens_updated_ms_) * loop_rate / 1000);
+    }
+    tokens_updated_ms_ = now;
+    if (tokens_ >= 1) {
+        return true;
+    }
+    accept_resume_at_ = now + max<int64_t>(static_cast<int64_t>((1 - tokens_) * 1000 / loop_rate), 1);
+    return false;
+}
+
+void EventLoop::spendToken() {
+    // admit刚补充并检查过令牌桶；速率在两次调用之间被开启时桶中可能还没有令牌
+    if (server_->accept_rate_ > 0 && tokens_ >= 1) {
+        tokens_ -= 1;
+    }
+}
+
+void EventLoop::pauseAccept() {
+    if (accept_paused_.exchange(true, memory_order_acq_rel)) {
+        return;
+    }
+    unwatchListener();
+    server_->paused_acceptors_.fetch_add(1, memory_order_acq_rel);
+    server_->deferred_count_.fetch_add(1, memory_order_relaxed);
+}
+
+void EventLoop::resumeAccept() {
+    accept_resume_at_ = 0;
+    if (server_socket_ == nullptr || handed_over_ || !accept_paused_.exchange(false, memory_order_acq_rel)) {
+        return;
+    }
+    server_->paused_acceptors_.fetch_sub(1, memory_order_acq_rel);
+    if (reserve_fd_ == -1) {
+        // 描述符耗尽时被其他线程占用的预留描述符在恢复接受时重新占用
+        reserve_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    }
+    // 水平触发注册，等待队列中仍有连接时下一轮立即就绪
+    watchListener();
+    // 暂停前已被accept请求接受的连接先于等待队列中的连接处理
+    if (!held_.empty()) {
+        acceptHeld();
+        finishAccept();
+    }
+}
+
+bool EventLoop::watchListener() {
+    // 自定义接受回调需要自己调用accept，只能以可读事件监听
+    accept_completion_ = completion_ && server_->defaultAccept() && poller_->addListener(listen_fd_, &listen_fd_);
+    return accept_completion_ || poller_->add(listen_fd_, EPOLLIN, &listen_fd_);
+}
+
+void EventLoop::unwatchListener() {
+    if (!accept_completion_) {
+        poller_->del(listen_fd_);
+        return;
+    }
+    settled_.clear();
+    poller_->settle(listen_fd_, settled_);
+    for (const Poller::Result &result: settled_) {
+        if (result.type == Poller::Completion::ACCEPT && result.res >= 0) {
+            held_.push_back(acceptedSocket(result.res));
+        }
+    }
+}
+
+void EventLoop::wakeAccept() {
+    if (!accept_paused_.load(memory_order_acquire) || resume_queued_.exchange(true, memory_order_acq_rel)) {
+        return;
+    }
+    queueInLoop([this]() {
+        resume_queued_.store(false, memory_order_release);
+        if (accept_resume_at_ == 0) {
+            resumeAccept();
+        }
+    });
+}
+
+void EventLoop::removeListenPath() const {
+    string path = server_->listen_addr_.getPath();
+    if (listen_fd_ != -1 && !handed_over_ && !path.empty() && path[0] != '@') {
+        unlink(path.c_str());
+    }
+}
+
+bool EventLoop::shedConnection() {
+    if (reserve_fd_ == -1) {
+        return false;
+    }
+    close(reserve_fd_);
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd != -1) {
+        close(fd);
+        server_->rejected_count_.fetch_add(1, memory_order_relaxed);
+    }
+    reserve_fd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return true;
+}
+
+void EventLoop::handleUpgrade() {
+    int channel_fd = accept4(upgrade_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (channel_fd == -1) {
+        return;
+    }
+    // 新进程完成接管后将在同一路径上监听，必须在移交前删除
+    poller_->del(upgrade_fd_);
+    close(upgrade_fd_);
+    unlink(upgrade_path_.c_str());
+    upgrade_fd_ = -1;
+    server_->handOver(channel_fd);
+}
+
+void EventLoop::handleWakeup() {
+    uint64_t count = 0;
+    read(wakeup_fd_, &count, sizeof(count));
+}
+
+void EventLoop::handleTimer() {
+    uint64_t count = 0;
+    read(timer_fd_, &count, sizeof(count));
+    wheel_->advance(currentTick(), [this](TimerNode *node) {
+        auto conn = static_cast<Connection *>(node->owner);
+        if (node == &conn->stall_timer) {
+            handleStall(conn);
+        } else {
+            handleIdle(conn);
+        }
+    });
+}
+
+void EventLoop::handleIdle(Connection *conn) {
+    uint64_t deadline = conn->last_active + idle_ticks_;
+    if (deadline > wheel_->now()) {
+        wheel_->add(&conn->idle_timer, deadline);
+        return;
+    }
+    if (server_->idle_cb_ == nullptr) {
+        closeClient(conn);
+        return;
+    }
+    uint32_t generation = conn->generation.load(memory_order_relaxed);
+    server_->idle_cb_(Socket(conn->fd, conn->addr_info), server_);
+    if (owns(conn, generation)) {
+        conn->last_active = wheel_->now();
+        wheel_->add(&conn->idle_timer, conn->last_active + idle_ticks_);
+    }
+}
+
+void EventLoop::handleStall(Connection *conn) {
+    if (conn->output.empty()) {
+        return;
+    }
+    uint64_t deadline = conn->last_progress + stall_ticks_;
+    if (deadline > wheel_->now()) {
+        wheel_->add(&conn->stall_timer, deadline);
+        return;
+    }
+    if (conn->sending) {
+        // 发送请求在内核中一直等待套接字可写，对端没有接收任何数据
+        closeClient(conn);
+        return;
+    }
+    // 发送队列腾出足够空间后才会触发可写事件，断开前再尝试写一次，确认对端确实没有接收任何数据
+    int saved_errno = 0;
+    if (conn->output.writeTo(conn->fd, &saved_errno) <= 0) {
+        closeClient(conn);
+        return;
+    }
+    conn->last_progress = wheel_->now();
+    updateOutput(conn);
+}
+
+uint64_t EventLoop::currentTick() const {
+    return static_cast<uint64_t>(TimerQueue::now()) / tick_ms_;
+}
+
+void EventLoop::doPendingFunctors() {
+    vector<Functor> functors;
+    {
+        lock_guard<mutex> lock(pending_mutex_);
+        functors.swap(pending_functors_);
+    }
+    calling_functors_ = true;
+    for (auto &functor: functors) {
+        functor();
+    }
+    calling_functors_ = false;
+}
+
+void EventLoop::wakeup() const {
+    uint64_t one = 1;
+    write(wakeup_fd_, &one, sizeof(one));
+}
+
+void EventLoop::addClient(const Socket &client, bool notify) {
+    Connection *conn = slab_->acquire(client.getFd());
+    if (conn == nullptr) {
+        server_->rejected_count_.fetch_add(1, memory_order_relaxed);
+        client.closeFd();
+        conn_count_.fetch_sub(1, memory_order_relaxed);
+        return;
+    }
+    conn->fd = client.getFd();
+    conn->addr_info = client.addr_info;
+    conn->index = conns_.size();
+    conns_.push_back(conn);
+    uint32_t session = 0;
+    while (session == 0) {
+        session = static_cast<uint32_t>(session_rng_());
+    }
+    conn->session.store(session, memory_order_relaxed);
+    conn->loop.store(this, memory_order_release);
+    conn->idle_timer.owner = conn;
+    conn->stall_timer.owner = conn;
+    if (idle_ticks_ > 0) {
+        conn->last_active = wheel_->now();
+        wheel_->add(&conn->idle_timer, conn->last_active + idle_ticks_);
+    }
+    conn->backed_up = false;
+    conn->write_closed = false;
+    if (server_->socket_options_.hasConnectionOptions() && server_->listen_addr_.getFamily() != AF_UNIX) {
+        string option;
+        server_->socket_options_.applyToAccepted(client, option);
+    }
+    size_t zerocopy_threshold = server_->zerocopy_threshold_;
+    bool packet = server_->socket_type_ == SOCK_SEQPACKET;
+    // 完成模型下内存数据块由发送请求写出，不使用零拷贝
+    if (completion_ && !packet) {
+        zerocopy_threshold = 0;
+    }
+    if (zerocopy_threshold > 0) {
+        int one = 1;
+        if (setsockopt(conn->fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == -1) {
+            zerocopy_threshold = 0;
+        }
+    }
+    conn->output.setZeroCopyThreshold(zerocopy_threshold);
+    conn->output.setPacketMode(packet);
+    conn->input.setPool(server_->buffer_pool_.get());
+    conn->sending = false;
+    watch(conn);
+    if (draining_) {
+        closeOutput(conn);
+    }
+    if (notify && server_->connect_cb_ != nullptr) {
+        server_->connect_cb_(client, server_);
+    }
+}
+
+Connection *EventLoop::addOutbound(const Socket &socket, TcpClient *client) {
+    Connection *conn = slab_->acquire(socket.getFd());
+    if (conn == nullptr) {
+        socket.closeFd();
+        return nullptr;
+    }
+    conn->fd = socket.getFd();
+    conn->addr_info = socket.addr_info;
+    conn->index = outbound_.size();
+    outbound_.push_back(conn);
+    uint32_t session = 0;
+    while (session == 0) {
+        session = static_cast<uint32_t>(session_rng_());
+    }
+    conn->session.store(session, memory_order_relaxed);
+    conn->loop.store(this, memory_order_release);
+    conn->idle_timer.owner = conn;
+    conn->stall_timer.owner = conn;
+    conn->backed_up = false;
+    conn->write_closed = false;
+    conn->client = client;
+    conn->connecting = true;
+    conn->completion = false;
+    conn->sending = false;
+    conn->output.setZeroCopyThreshold(0);
+    conn->output.setPacketMode(false);
+    conn->input.setPool(server_->buffer_pool_.get());
+    conn->events = poller_->edgeTriggered() ? EPOLLOUT | EPOLLET : EPOLLOUT;
+    poller_->add(conn->fd, conn->events, conn);
+    return conn;
+}
+
+void EventLoop::watch(Connection *conn) {
+    // 记录套接字需要逐条读取以保留记录边界，不使用recv请求
+    conn->completion = completion_ && (conn->client != nullptr || server_->socket_type_ != SOCK_SEQPACKET);
+    conn->events = interestOf(conn);
+    if (conn->completion && poller_->addReceiver(conn->fd, conn->events, conn)) {
+        return;
+    }
+    conn->completion = false;
+    conn->events = interestOf(conn);
+    poller_->add(conn->fd, conn->events, conn);
+}
+
+void EventLoop::settle(Connection *conn) {
+    settled_.clear();
+    poller_->settle(conn->fd, settled_);
+    for (const Poller::Result &result: settled_) {
+        if (result.type == Poller::Completion::RECV && result.res > 0) {
+            conn->input.append(result.data, static_cast<size_t>(result.res));
+        } else if (result.type == Poller::Completion::SEND && result.res > 0) {
+            conn->output.retrieve(static_cast<size_t>(result.res));
+        }
+    }
+    conn->sending = false;
+}
+
+Connection *EventLoop::getClient(int fd) const {
+    Connection *conn = slab_->get(fd);
+    if (conn == nullptr || conn->loop.load(memory_order_relaxed) != this) {
+        return nullptr;
+    }
+    return conn;
+}
+
+void EventLoop::handleRead(Connection *conn) {
+    Buffer &input = conn->input;
+    if (input.capacity() == 0) {
+        input.ensureWritableBytes(rbuf_size_);
+    }
+    int saved_errno = 0;
+    bool closed = false;
+    bool packet = conn->client == nullptr && server_->socket_type_ == SOCK_SEQPACKET;
+    while (true) {
+        size_t writable = input.writableBytes();
+        ssize_t rlen = input.readFd(conn->fd, &saved_errno);
+        if (rlen > 0 && packet) {
+            // 每次只读到一条记录，逐条交付以保留记录边界，直到EAGAIN
+            uint32_t generation = conn->generation.load(memory_order_relaxed);
+            bool invalid = deliver(conn);
+            if (!owns(conn, generation)) {
+                return;
+            }
+            if (invalid) {
+                closeClient(conn);
+                return;
+            }
+        } else if (rlen > 0) {
+            // 未读满说明内核接收队列已读空，水平触发下无需再以一次EAGAIN确认，剩余事件会再次通知；
+            // 边沿触发下与数据同一次到达的FIN不会再产生边沿，必须读到EAGAIN或0
+            if (!poller_->edgeTriggered() && static_cast<size_t>(rlen) < writable + Buffer::kSpillSize) {
+                break;
+            }
+        } else if (rlen == -1 && saved_errno == EINTR) {
+            continue;
+        } else {
+            closed = rlen == 0 || saved_errno != EAGAIN;
+            break;
+        }
+    }
+    finishRead(conn, closed);
+}
+
+void EventLoop::handleReceived(Connection *conn, const char *data, int len) {
+    Buffer &input = conn->input;
+    if (len > 0) {
+        if (input.capacity() == 0) {
+            input.ensureWritableBytes(rbuf_size_);
+        }
+        input.append(data, static_cast<size_t>(len));
+    }
+    finishRead(conn, len <= 0);
+}
+
+void EventLoop::finishRead(Connection *conn, bool closed) {
+    Buffer &input = conn->input;
+    if (wheel_ != nullptr) {
+        conn->last_active = wheel_->now();
+    }
+    uint32_t generation = conn->generation.load(memory_order_relaxed);
+    bool invalid = deliver(conn);
+    if (!owns(conn, generation)) {
+        return;
+    }
+    if (closed || invalid) {
+        closeClient(conn);
+        return;
+    }
+    // 数据已全部交付，归还借用的块使空闲连接不占用接收缓冲区；未启用内存块池时只释放扩容的部分
+    if (input.readableBytes() == 0
+        && (server_->buffer_pool_ != nullptr || input.capacity() > rbuf_size_ + Buffer::kCheapPrepend)) {
+        input.release();
+    }
+}
+
+bool EventLoop::deliver(Connection *conn) {
+    Buffer &input = conn->input;
+    uint32_t generation = conn->generation.load(memory_order_relaxed);
+    TcpClient *client = conn->client;
+    const shared_ptr<Codec> &codec = client != nullptr ? client->codec_ : server_->codec_;
+    const char *frame = nullptr;
+    size_t frame_len = 0;
+    while (input.readableBytes() > 0) {
+        ssize_t used = static_cast<ssize_t>(input.readableBytes());
+        frame = input.peek();
+        frame_len = input.readableBytes();
+        if (codec != nullptr) {
+            used = codec->decode(input.peek(), input.readableBytes(), &frame, &frame_len);
+            if (used == 0) {
+                break;
+            } else if (used < 0) {
+                input.retrieveAll();
+                return true;
+            }
+        }
+        if (client != nullptr) {
+            if (client->message_cb_ != nullptr) {
+                client->message_cb_(Socket(conn->fd, conn->addr_info), frame, frame_len, client);
+            }
+        } else if (server_->message_cb_ != nullptr) {
+            server_->message_cb_(Socket(conn->fd, conn->addr_info), frame, frame_len, server_);
+        } else {
+            message_.assign(frame, frame_len);
+            server_->recv_cb_(Socket(conn->fd, conn->addr_info), message_, server_);
+        }
+        if (!owns(conn, generation)) {
+            break;
+        }
+        input.retrieve(used);
+    }
+    return false;
+}
+
+void EventLoop::handleConnect(Connection *conn) {
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len) == -1) {
+        err = errno;
+    }
+    if (err == 0) {
+        conn->connecting = false;
+        if (completion_) {
+            // 握手期间以监听请求等待可写，建立后改以recv请求接收数据
+            poller_->del(conn->fd);
+            watch(conn);
+        } else {
+            conn->events = interestOf(conn);
+            poller_->mod(conn->fd, conn->events, conn);
+        }
+    }
+    conn->client->handleConnect(conn, err);
+}
+
+void EventLoop::handleWrite(Connection *conn) {
+    int saved_errno = 0;
+    bool progressed = false;
+    while (!conn->output.empty() && !conn->sending) {
+        // 写方向关闭后提交的请求只会失败，与同步写出一样把数据留在队列中
+        if (conn->completion && !conn->write_closed && submitSend(conn)) {
+            break;
+        }
+        ssize_t slen = conn->output.writeTo(conn->fd, &saved_errno);
+        if (slen == -1) {
+            break;
+        }
+        progressed = progressed || slen > 0;
+    }
+    if (progressed && wheel_ != nullptr) {
+        conn->last_progress = wheel_->now();
+    }
+    updateOutput(conn);
+}
+
+bool EventLoop::submitSend(Connection *conn) {
+    struct iovec iov[Poller::kMaxSendIov];
+    bool more = false;
+    size_t count = conn->output.gather(iov, Poller::kMaxSendIov, &more);
+    // 后面紧跟文件或管道时让内核等待后续数据，避免头部单独成为一个小报文
+    if (count == 0 || !poller_->send(conn->fd, iov, count, MSG_NOSIGNAL | (more ? MSG_MORE : 0))) {
+        return false;
+    }
+    conn->sending = true;
+    return true;
+}
+
+void EventLoop::handleSent(Connection *conn, int len) {
+    conn->sending = false;
+    if (len > 0) {
+        conn->output.retrieve(static_cast<size_t>(len));
+        if (wheel_ != nullptr) {
+            conn->last_progress = wheel_->now();
+        }
+        handleWrite(conn);
+    } else if (len == 0 || len == -EAGAIN || len == -EINTR) {
+        // 关心可写事件，就绪后重新提交
+        updateOutput(conn);
+    } else {
+        closeClient(conn);
+    }
+}
+
+void EventLoop::updateOutput(Connection *conn) {
+    size_t queued = conn->output.size();
+    if (stall_ticks_ > 0) {
+        if (queued == 0) {
+            wheel_->remove(&conn->stall_timer);
+        } else if (!conn->stall_timer.linked()) {
+            conn->last_progress = wheel_->now();
+            wheel_->add(&conn->stall_timer, conn->last_progress + stall_ticks_);
+        }
+    }
+    const TcpServer::WaterMarkCallBack *callback = nullptr;
+    // 服务端的水位回调以服务端连接为对象，不作用于主动连接
+    size_t high_water_mark = conn->client == nullptr ? server_->high_water_mark_ : 0;
+    if (high_water_mark > 0 && !conn->backed_up && queued >= high_water_mark) {
+        conn->backed_up = true;
+        callback = &server_->high_water_cb_;
+    } else if (conn->backed_up && queued <= server_->low_water_mark_) {
+        conn->backed_up = false;
+        callback = &server_->low_water_cb_;
+    }
+    uint32_t events = interestOf(conn);
+    if (events != conn->events) {
+        conn->events = events;
+        poller_->mod(conn->fd, events, conn);
+    }
+    if (draining_ && queued == 0) {
+        closeOutput(conn);
+    }
+    // 回调放在最后，回调中断开连接或继续发送都不会影响上面的状态更新
+    if (callback != nullptr && *callback != nullptr) {
+        (*callback)(Socket(conn->fd, conn->addr_info), queued, server_);
+    }
+}
+
+uint32_t EventLoop::interestOf(const Connection *conn) const {
+    uint32_t events = (conn->backed_up && server_->pause_reading_) ? 0u : static_cast<uint32_t>(EPOLLIN);
+    if (conn->completion) {
+        // 内存数据块由发送请求写出，只在文件、管道写不进或发送请求返回EAGAIN后等待可写
+        if (!conn->output.empty() && !conn->sending && !conn->write_closed) {
+            events |= EPOLLOUT;
+        }
+    } else if (poller_->edgeTriggered()) {
+        // 边沿触发下始终关心可写事件，避免发送缓冲区每次空与非空切换时都要修改注册
+        events |= EPOLLOUT | EPOLLET;
+    } else if (!conn->output.empty() && !conn->write_closed) {
+        // 写方向关闭后套接字始终可写，排空后追加的数据只能留在队列中
+        events |= EPOLLOUT;
+    }
+    return events;
+}
+
+void EventLoop::closeClient(Connection *conn) {
+    if (conn->client != nullptr) {
+        // 由发起连接的Tcp客户端执行连接断开回调并安排重连
+        conn->client->handleClose(conn);
+        return;
+    }
+    if (server_->close_cb_ != nullptr) {
+        uint32_t generation = conn->generation.load(memory_order_relaxed);
+        server_->close_cb_(Socket(conn->fd, conn->addr_info), server_);
+        if (!owns(conn, generation)) {
+            return;
+        }
+    }
+    disConnect(conn);
+}
@@ -0,0 +1,214 @@
+#include "OutputBuffer.h"
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+
+using namespace std;
+using namespace CwNetWork;
+
+// 单次sendmsg聚集的最大数据块数
+static const size_t kMaxIov = 64;
+// 发送完毕后保留的数据块队列容量，超出时释放，避免一次突发写入让空闲连接长期占用内存
+static const size_t kIdleSegments = 4;
+
+void OutputBuffer::append(const char *data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    append(make_shared<const string>(data, len));
+}
+
+void OutputBuffer::append(Chunk chunk, size_t offset) {
+    if (chunk == nullptr || offset >= chunk->size()) {
+        return;
+    }
+    size_t remain = chunk->size() - offset;
+    size_ += remain;
+    segments_.push_back({std::move(chunk), offset, remain, -1, false});
+}
+
+void OutputBuffer::appendFile(int file_fd, off_t offset, size_t len) {
+    if (len == 0) {
+        close(file_fd);
+        return;
+    }
+    size_ += len;
+    segments_.push_back({nullptr, static_cast<size_t>(offset), len, file_fd, false});
+}
+
+void OutputBuffer::appendPipe(int pipe_fd, size_t len) {
+    if (len == 0) {
+        close(pipe_fd);
+        return;
+    }
+    size_ += len;
+    segments_.push_back({nullptr, 0, len, pipe_fd, true});
+}
+
+ssize_t OutputBuffer::writeTo(int fd, int *saved_errno) {
+    if (head_ == segments_.size()) {
+        return 0;
+    }
+    Segment &head = segments_[head_];
+    ssize_t slen = 0;
+    if (head.fd == -1) {
+        slen = writeChunks(fd);
+    } else if (head.pipe) {
+        unsigned int flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK | (head_ + 1 < segments_.size() ? SPLICE_F_MORE : 0);
+        slen = splice(head.fd, nullptr, fd, nullptr, head.remain, flags);
+    } else {
+        auto offset = static_cast<off_t>(head.offset);
+        slen = sendfile(fd, head.fd, &offset, head.remain);
+    }
+    if (slen == -1) {
+        *saved_errno = errno;
+        return -1;
+    }
+    if (slen == 0) {
+        // 文件被截断或管道写端已关闭，该段剩余的数据不会再到来
+        size_ -= head.remain;
+        pop();
+        return 0;
+    }
+    consume(slen);
+    return slen;
+}
+
+bool OutputBuffer::reapZeroCopy(int fd) {
+    bool reaped = false;
+    char control[128];
+    while (true) {
+        struct msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE) == -1) {
+            break;
+        }
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (!(cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) &&
+                !(cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)) {
+                continue;
+            }
+            auto err = reinterpret_cast<const struct sock_extended_err *>(CMSG_DATA(cm));
+            if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+            // 通知为闭区间[ee_info, ee_data]，序号按32位回绕
+            uint32_t low = err->ee_info, span = err->ee_data - err->ee_info;
+            zerocopy_pending_.erase(remove_if(zerocopy_pending_.begin(), zerocopy_pending_.end(),
+                                              [low, span](const pair<uint32_t, Chunk> &item) {
+                                                  return item.first - low <= span;
+                                              }), zerocopy_pending_.end());
+            if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                // 内核已回退为复制发送，继续零拷贝只会多出页锁定和通知的开销
+                zerocopy_threshold_ = 0;
+            }
+            reaped = true;
+        }
+    }
+    return reaped;
+}
+
+size_t OutputBuffer::gather(struct iovec *iov, size_t max_count, bool *more) const {
+    size_t count = 0;
+    size_t i = head_;
+    max_count = packet_ ? min<size_t>(max_count, 1) : max_count;
+    for (; i < segments_.size() && segments_[i].fd == -1 && count < max_count; ++i, ++count) {
+        iov[count].iov_base = const_cast<char *>(segments_[i].chunk->data() + segments_[i].offset);
+        iov[count].iov_len = segments_[i].remain;
+    }
+    *more = i < segments_.size() && segments_[i].fd != -1;
+    return count;
+}
+
+void OutputBuffer::clear() {
+    while (head_ < segments_.size()) {
+        pop();
+    }
+    vector<Segment>().swap(segments_);
+    head_ = 0;
+    size_ = 0;
+    zerocopy_pending_.clear();
+    zerocopy_next_ = 0;
+}
+
+ssize_t OutputBuffer::writeChunks(int fd) {
+    struct iovec iov[kMaxIov];
+    size_t count = 0;
+    size_t i = head_;
+    bool zerocopy = zerocopy_threshold_ > 0 && segments_[head_].remain >= zerocopy_threshold_;
+    size_t max_count = packet_ ? 1 : kMaxIov;
+    for (; i < segments_.size() && segments_[i].fd == -1 && count < max_count; ++i, ++count) {
+        const Segment &segment = segments_[i];
+        if (zerocopy_threshold_ > 0 && (segment.remain >= zerocopy_threshold_) != zerocopy) {
+            break;
+        }
+        iov[count].iov_base = const_cast<char *>(segment.chunk->data() + segment.offset);
+        iov[count].iov_len = segment.remain;
+    }
+    struct msghdr msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    // 后面紧跟文件或管道时让内核等待后续数据，避免头部单独成为一个小报文
+    bool more = i < segments_.size() && segments_[i].fd != -1;
+    int flags = MSG_NOSIGNAL | (more ? MSG_MORE : 0);
+    if (!zerocopy) {
+        return sendmsg(fd, &msg, flags);
+    }
+    ssize_t slen = sendmsg(fd, &msg, flags | MSG_ZEROCOPY);
+    if (slen == -1 && errno == ENOBUFS) {
+        // 未完成的通知超出了套接字的optmem限额，本次退回复制发送
+        return sendmsg(fd, &msg, flags);
+    }
+    if (slen > 0) {
+        // 内核在完成通知前一直引用本次发送的页，持有被发送到的每个数据块
+        size_t covered = 0;
+        for (size_t j = 0; j < count && covered < static_cast<size_t>(slen); ++j) {
+            zerocopy_pending_.emplace_back(zerocopy_next_, segments_[head_ + j].chunk);
+            covered += iov[j].iov_len;
+        }
+        ++zerocopy_next_;
+    }
+    return slen;
+}
+
+void OutputBuffer::consume(size_t len) {
+    size_ -= len;
+    while (len > 0) {
+        Segment &segment = segments_[head_];
+        if (len < segment.remain) {
+            segment.offset += len;
+            segment.remain -= len;
+            return;
+        }
+        len -= segment.remain;
+        pop();
+    }
+}
+
+void OutputBuffer::pop() {
+    Segment &segment = segments_[head_];
+    if (segment.fd != -1) {
+        close(segment.fd);
+        segment.fd = -1;
+    }
+    segment.chunk.reset();
+    ++head_;
+    if (head_ == segments_.size()) {
+        if (segments_.capacity() > kIdleSegments) {
+            vector<Segment>().swap(segments_);
+        } else {
+            segments_.clear();
+        }
+        head_ = 0;
+    } else if (head_ > segments_.size() / 2) {
+        segments_.erase(segments_.begin(), segments_.begin() + head_);
+        head_ = 0;
+    }
+}
@@ -0,0 +1,66 @@
+#include "PollPoller.h"
+
+using namespace std;
+using namespace CwNetWork;
+
+// poll(2)能够表示的事件，EPOLLIN等低位与POLLIN等取值相同
+static const uint32_t kPollMask = 0xffff;
+
+bool PollPoller::add(int fd, uint32_t events, void *ptr) {
+    if (fd < 0) {
+        return false;
+    }
+    if (static_cast<size_t>(fd) >= index_.size()) {
+        index_.resize(fd + 1, -1);
+    }
+    if (index_[fd] != -1) {
+        return false;
+    }
+    index_[fd] = static_cast<int>(pollfds_.size());
+    pollfds_.push_back({fd, static_cast<short>(events & kPollMask), 0});
+    ptrs_.push_back(ptr);
+    return true;
+}
+
+bool PollPoller::mod(int fd, uint32_t events, void *ptr) {
+    if (fd < 0 || static_cast<size_t>(fd) >= index_.size() || index_[fd] == -1) {
+        return false;
+    }
+    pollfds_[index_[fd]].events = static_cast<short>(events & kPollMask);
+    ptrs_[index_[fd]] = ptr;
+    return true;
+}
+
+bool PollPoller::del(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= index_.size() || index_[fd] == -1) {
+        return false;
+    }
+    int index = index_[fd];
+    pollfds_[index] = pollfds_.back();
+    ptrs_[index] = ptrs_.back();
+    index_[pollfds_[index].fd] = index;
+    pollfds_.pop_back();
+    ptrs_.pop_back();
+    index_[fd] = -1;
+    return true;
+}
+
+int PollPoller::wait(int timeout) {
+    int ready = poll(pollfds_.data(), pollfds_.size(), timeout);
+    if (ready <= 0) {
+        return ready;
+    }
+    if (events_.size() < static_cast<size_t>(ready)) {
+        events_.resize(ready);
+    }
+    int ev_num = 0;
+    for (size_t i = 0; i < pollfds_.size() && ev_num < ready; ++i) {
+        if (pollfds_[i].revents == 0) {
+            continue;
+        }
+        events_[ev_num].events = static_cast<uint16_t>(pollfds_[i].revents);
+        events_[ev_num].data.ptr = ptrs_[i];
+        ++ev_num;
+    }
+    return ev_num;
+}
@@ -0,0 +1,29 @@
+#include "Poller.h"
+#include "EpollPoller.h"
+#include "PollPoller.h"
+#include "UringPoller.h"
+
+using namespace std;
+using namespace CwNetWork;
+
+unique_ptr<Poller> Poller::newPoller(IoBackend backend) {
+    unique_ptr<Poller> poller;
+    switch (backend) {
+        case IoBackend::EPOLL_LT:
+            poller.reset(new EpollPoller(false));
+            break;
+        case IoBackend::POLL:
+            poller.reset(new PollPoller());
+            break;
+        case IoBackend::IO_URING:
+            poller.reset(new UringPoller());
+            break;
+        default:
+            poller.reset(new EpollPoller(true));
+            break;
+    }
+    if (!poller->valid()) {
+        poller.reset();
+    }
+    return poller;
+}
@@ -1,4 +1,7 @@
 #include "ServerSocket.h"
+#include <netinet/tcp.h>
+#include <sys/stat.h>
+#include <cerrno>
 #include <cstring>
 #include <unistd.h>
 #include <fcntl.h>
@@ -6,16 +9,28 @@
 using namespace std;
 using namespace CwNetWork;
 
-ServerSocket::ServerSocket() {
-    fd_ = socket(AF_INET, SOCK_STREAM, 0);
-}
-
 bool ServerSocket::setSockReuable() const {
     int flag = 1;
     bool ret = setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &flag, sizeof(int));
     return !ret;
 }
 
+bool ServerSocket::setReusePort() const {
+    int flag = 1;
+    bool ret = setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT, &flag, sizeof(int));
+    return !ret;
+}
+
+bool ServerSocket::setDeferAccept(int seconds) const {
+    bool ret = setsockopt(fd_, IPPROTO_TCP, TCP_DEFER_ACCEPT, &seconds, sizeof(int));
+    return !ret;
+}
+
+bool ServerSocket::setFastOpen(int queue_len) const {
+    bool ret = setsockopt(fd_, IPPROTO_TCP, TCP_FASTOPEN, &queue_len, sizeof(int));
+    return !ret;
+}
+
 void ServerSocket::setNonBlock() const {
     int flag = fcntl(fd_, F_GETFL);
     flag |= O_NONBLOCK;
@@ -23,12 +38,26 @@ void ServerSocket::setNonBlock() const {
 }
 
 bool ServerSocket::serverBind(int port) const {
-    struct sockaddr_in servaddr;
-    memset(&servaddr, 0, sizeof(servaddr));
-    servaddr.sin_family = AF_INET;
-    servaddr.sin_addr.s_addr = htonl(INADDR_ANY);
-    servaddr.sin_port = htons(port);
-    bool ret = bind(fd_, (struct sockaddr *) &servaddr, sizeof(servaddr));
+    return serverBind(AddrInfo::anyAddress(static_cast<unsigned short>(port)));
+}
+
+bool ServerSocket::serverBind(const AddrInfo &addr) const {
+    string path = addr.getPath();
+    struct stat st{};
+    if (!path.empty() && path[0] != '@' && lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        // 上次运行残留的套接字文件会使bind失败；仍有进程在监听时保留，由bind报告地址已被占用
+        int type = 0;
+        socklen_t len = sizeof(type);
+        getsockopt(fd_, SOL_SOCKET, SO_TYPE, &type, &len);
+        int probe = socket(AF_UNIX, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (probe != -1 && connect(probe, addr.getSockAddrPtr(), addr.getSockLen()) == -1 && errno == ECONNREFUSED) {
+            unlink(path.c_str());
+        }
+        if (probe != -1) {
+            close(probe);
+        }
+    }
+    bool ret = bind(fd_, addr.getSockAddrPtr(), addr.getSockLen());
     return !ret;
 }
 
@@ -38,8 +67,14 @@ bool ServerSocket::serverListen(int n) const {
 }
 
 Socket ServerSocket::serverAccept() const {
+    return serverAccept(0);
+}
+
+Socket ServerSocket::serverAccept(int flags) const {
     AddrInfo info;
-    int client_fd = accept(fd_, info.getSockAddrPtr(), &kSocklen);
+    socklen_t len = AddrInfo::kMaxSockLen;
+    int client_fd = accept4(fd_, info.getSockAddrPtr(), &len, flags);
+    info.setSockLen(len);
     return Socket(client_fd, info);
 }
 
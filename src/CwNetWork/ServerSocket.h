@@ -18,9 +18,23 @@ namespace CwNetWork {
 
         /**
           * @brief  构造一个服务端套接字对象
+          * @param  _1:地址族，如AF_INET、AF_INET6、AF_UNIX _2:套接字类型，SOCK_STREAM或SOCK_SEQPACKET
           * @retval ServerSocket
           */
-        static ServerSocket newServerSocket() { return {}; }
+        static ServerSocket newServerSocket(int family = AF_INET, int type = SOCK_STREAM) {
+            ServerSocket server_socket(socket(family, type, 0));
+            return server_socket;
+        }
+
+        /**
+          * @brief  接管一个已经处于监听状态的服务端套接字描述符，如热升级时从旧进程继承的描述符
+          * @param  服务端套接字描述符
+          * @retval ServerSocket
+          */
+        static ServerSocket fromFd(int fd) {
+            ServerSocket server_socket(fd);
+            return server_socket;
+        }
 
         /**
           * @brief  开启服务端套接字端口可重用
@@ -28,6 +42,43 @@ namespace CwNetWork {
           */
         bool setSockReuable() const;
 
+        /**
+          * @brief  开启SO_REUSEPORT，允许多个服务端套接字绑定同一端口并由内核分发连接
+          * @retval 是否开启成功
+          */
+        bool setReusePort() const;
+
+        /**
+          * @brief  设置服务端套接字的发送缓冲区大小，accept得到的套接字继承该值
+          * @param  字节数
+          * @retval 是否设置成功
+          */
+        bool setSendBuffer(int bytes) const { return Socket(fd_).setSendBuffer(bytes); }
+
+        /**
+          * @brief  设置服务端套接字的接收缓冲区大小，accept得到的套接字继承该值
+          * @note   需在serverListen之前设置，握手时才能通告相应的窗口扩大因子
+          * @param  字节数
+          * @retval 是否设置成功
+          */
+        bool setRecvBuffer(int bytes) const { return Socket(fd_).setRecvBuffer(bytes); }
+
+        /**
+          * @brief  设置TCP_DEFER_ACCEPT，连接收到首个数据后才从accept返回
+          * @note   超时后内核仍会交付没有数据的连接
+          * @param  等待数据的秒数，0表示关闭
+          * @retval 是否设置成功
+          */
+        bool setDeferAccept(int) const;
+
+        /**
+          * @brief  开启服务端TCP_FASTOPEN，允许客户端在SYN中携带数据
+          * @note   需系统net.ipv4.tcp_fastopen开启服务端支持(第2位)
+          * @param  尚未完成握手的Fast Open连接队列长度，0表示关闭
+          * @retval 是否设置成功
+          */
+        bool setFastOpen(int) const;
+
         /**
           * @brief  设置socket非阻塞
           */
@@ -35,11 +86,20 @@ namespace CwNetWork {
 
         /**
           * @brief  将该服务端套接字对象与本机的指定端口绑定
+          * @note   绑定IPv4通配地址，其他地址族使用serverBind(const AddrInfo &)
           * @param  绑定的端口号
           * @retval 是否成功绑定
           */
         bool serverBind(int) const;
 
+        /**
+          * @brief  将该服务端套接字对象与指定地址绑定
+          * @note   Unix域套接字路径上已无人监听的残留套接字文件会被先删除，其他类型的文件不会被删除
+          * @param  地址，地址族须与创建套接字时一致
+          * @retval 是否成功绑定
+          */
+        bool serverBind(const AddrInfo &) const;
+
         /**
           * @brief  服务端开启监听绑定好的端口
           * @param  参数为等待队列最大长度
@@ -54,6 +114,13 @@ namespace CwNetWork {
           */
         Socket serverAccept() const;
 
+        /**
+          * @brief  使用accept4接受一个客户端的连接请求，并原子地为新套接字设置标志
+          * @param  accept4的标志，如SOCK_NONBLOCK | SOCK_CLOEXEC
+          * @retval 客户端Socket对象，失败时文件描述符为-1
+          */
+        Socket serverAccept(int) const;
+
         /**
           * @brief  关闭服务端套接字描述符
           * @note   请勿对一个ServerSocket对象重复执行关闭操作
@@ -68,7 +135,7 @@ namespace CwNetWork {
 
     private:
 
-        ServerSocket();
+        explicit ServerSocket(int fd) : fd_(fd) {}
 
         int fd_ = -1;
 
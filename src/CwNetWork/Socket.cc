@@ -1,4 +1,5 @@
 #include "Socket.h"
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <fcntl.h>
 
@@ -11,14 +12,57 @@ void Socket::setNonBlock() const {
     fcntl(fd_, F_SETFL, flag);
 }
 
+static bool setIntOption(int fd, int level, int name, int value) {
+    return setsockopt(fd, level, name, &value, sizeof(value)) == 0;
+}
+
+bool Socket::setNoDelay(bool on) const {
+    return setIntOption(fd_, IPPROTO_TCP, TCP_NODELAY, on);
+}
+
+bool Socket::setSendBuffer(int bytes) const {
+    return setIntOption(fd_, SOL_SOCKET, SO_SNDBUF, bytes);
+}
+
+bool Socket::setRecvBuffer(int bytes) const {
+    return setIntOption(fd_, SOL_SOCKET, SO_RCVBUF, bytes);
+}
+
+bool Socket::setFastOpenConnect(bool on) const {
+    return setIntOption(fd_, IPPROTO_TCP, TCP_FASTOPEN_CONNECT, on);
+}
+
+bool Socket::setNotSentLowat(int bytes) const {
+    return setIntOption(fd_, IPPROTO_TCP, TCP_NOTSENT_LOWAT, bytes);
+}
+
+bool Socket::setQuickAck(bool on) const {
+    return setIntOption(fd_, IPPROTO_TCP, TCP_QUICKACK, on);
+}
+
+bool Socket::setBusyPoll(int usec) const {
+    return setIntOption(fd_, SOL_SOCKET, SO_BUSY_POLL, usec);
+}
+
+bool Socket::setLinger(bool on, int seconds) const {
+    struct linger linger{};
+    linger.l_onoff = on ? 1 : 0;
+    linger.l_linger = seconds;
+    return setsockopt(fd_, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger)) == 0;
+}
+
+bool Socket::setUserTimeout(unsigned int ms) const {
+    return setsockopt(fd_, IPPROTO_TCP, TCP_USER_TIMEOUT, &ms, sizeof(ms)) == 0;
+}
+
 bool Socket::connectToHost(const char *ip, unsigned short port) const {
     AddrInfo info(ip, port);
-    bool ret = connect(fd_, info.getSockAddrPtr(), kSocklen);
+    bool ret = connect(fd_, info.getSockAddrPtr(), info.getSockLen());
     return !ret;
 }
 
 bool Socket::connectToHost(const AddrInfo &server_info) const {
-    bool ret = connect(fd_, server_info.getSockAddrPtr(), kSocklen);
+    bool ret = connect(fd_, server_info.getSockAddrPtr(), server_info.getSockLen());
     return !ret;
 }
 
@@ -27,8 +71,8 @@ bool Socket::closeFd() const {
     return !ret;
 }
 
-Socket Socket::newSocket() {
-    int fd = socket(AF_INET, SOCK_STREAM, 0);
+Socket Socket::newSocket(int family, int type) {
+    int fd = socket(family, type, 0);
     return Socket(fd);
 }
 
@@ -0,0 +1,68 @@
+#include "SocketOptions.h"
+
+using namespace std;
+using namespace CwNetWork;
+
+bool SocketOptions::applyTo(const ServerSocket &server_socket, string &error) const {
+    if (send_buffer_ != -1 && !server_socket.setSendBuffer(send_buffer_)) {
+        error = "SO_SNDBUF";
+        return false;
+    }
+    if (recv_buffer_ != -1 && !server_socket.setRecvBuffer(recv_buffer_)) {
+        error = "SO_RCVBUF";
+        return false;
+    }
+    if (defer_accept_ != -1 && !server_socket.setDeferAccept(defer_accept_)) {
+        error = "TCP_DEFER_ACCEPT";
+        return false;
+    }
+    if (fast_open_ != -1 && !server_socket.setFastOpen(fast_open_)) {
+        error = "TCP_FASTOPEN";
+        return false;
+    }
+    return true;
+}
+
+bool SocketOptions::applyToAccepted(const Socket &socket, string &error) const {
+    if (no_delay_ != -1 && !socket.setNoDelay(no_delay_ != 0)) {
+        error = "TCP_NODELAY";
+        return false;
+    }
+    if (notsent_lowat_ != -1 && !socket.setNotSentLowat(notsent_lowat_)) {
+        error = "TCP_NOTSENT_LOWAT";
+        return false;
+    }
+    if (quick_ack_ != -1 && !socket.setQuickAck(quick_ack_ != 0)) {
+        error = "TCP_QUICKACK";
+        return false;
+    }
+    if (busy_poll_ != -1 && !socket.setBusyPoll(busy_poll_)) {
+        error = "SO_BUSY_POLL";
+        return false;
+    }
+    if (linger_ != -1 && !socket.setLinger(linger_ != 0, linger_seconds_)) {
+        error = "SO_LINGER";
+        return false;
+    }
+    if (user_timeout_ != -1 && !socket.setUserTimeout(static_cast<unsigned int>(user_timeout_))) {
+        error = "TCP_USER_TIMEOUT";
+        return false;
+    }
+    return true;
+}
+
+bool SocketOptions::applyToClient(const Socket &socket, string &error) const {
+    if (send_buffer_ != -1 && !socket.setSendBuffer(send_buffer_)) {
+        error = "SO_SNDBUF";
+        return false;
+    }
+    if (recv_buffer_ != -1 && !socket.setRecvBuffer(recv_buffer_)) {
+        error = "SO_RCVBUF";
+        return false;
+    }
+    if (fast_open_connect_ != -1 && !socket.setFastOpenConnect(fast_open_connect_ != 0)) {
+        error = "TCP_FASTOPEN_CONNECT";
+        return false;
+    }
+    return applyToAccepted(socket, error);
+}
@@ -0,0 +1,171 @@
+#include "TcpClient.h"
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+using namespace CwNetWork;
+
+TcpClient::TcpClient(TcpServer *server, const AddrInfo &addr_info) : server_(server), addr_info_(addr_info) {}
+
+void TcpClient::connect() {
+    stopped_.store(false, memory_order_release);
+    server_->runAfter(0, [this]() {
+        retry_delay_ms_ = retry_initial_ms_;
+        startConnect();
+    });
+}
+
+void TcpClient::disconnect() {
+    stopped_.store(true, memory_order_release);
+    server_->runAfter(0, [this]() {
+        retry_timer_.cancel();
+        if (conn_ != nullptr) {
+            loop_->disConnect(conn_);
+        }
+    });
+}
+
+bool TcpClient::send(const string &message) {
+    EventLoop *loop = nullptr;
+    Connection *conn = nullptr;
+    uint32_t generation = 0;
+    {
+        lock_guard<mutex> lock(mutex_);
+        if (!connected_) {
+            return false;
+        }
+        loop = loop_;
+        conn = conn_;
+        generation = generation_;
+    }
+    if (loop->isInLoopThread()) {
+        loop->sendAll(conn, message);
+        return true;
+    }
+    loop->queueInLoop([loop, conn, generation, message]() {
+        if (loop->owns(conn, generation)) {
+            loop->sendAll(conn, message);
+        }
+    });
+    return true;
+}
+
+bool TcpClient::isConnected() const {
+    lock_guard<mutex> lock(mutex_);
+    return connected_;
+}
+
+string TcpClient::getError() const {
+    lock_guard<mutex> lock(mutex_);
+    return error_;
+}
+
+void TcpClient::startConnect() {
+    // 由重连定时器之外的途径发起时，尚未到期的重连不再需要
+    retry_timer_.cancel();
+    if (stopped_.load(memory_order_acquire) || conn_ != nullptr) {
+        return;
+    }
+    EventLoop *loop = EventLoop::current();
+    {
+        lock_guard<mutex> lock(mutex_);
+        loop_ = loop;
+    }
+    Socket socket = Socket::newSocket(addr_info_.getFamily(), SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (socket.getFd() == -1) {
+        retryLater("failed to create the client socket");
+        return;
+    }
+    socket.addr_info = addr_info_;
+    string option;
+    if (addr_info_.getFamily() != AF_UNIX && !socket_options_.applyToClient(socket, option)) {
+        socket.closeFd();
+        retryLater("failed to set the socket option " + option);
+        return;
+    }
+    if (::connect(socket.getFd(), addr_info_.getSockAddrPtr(), addr_info_.getSockLen()) == -1 && errno != EINPROGRESS) {
+        int saved_errno = errno;
+        socket.closeFd();
+        retryLater("failed to connect to " + addr_info_.toString() + ": " + strerror(saved_errno));
+        return;
+    }
+    // 立即完成的连接(如Unix域套接字)同样等待可写事件，与握手中的连接走同一条路径
+    Connection *conn = loop->addOutbound(socket, this);
+    if (conn == nullptr) {
+        retryLater("the client socket exceeds the capacity of the connection slab");
+        return;
+    }
+    uint32_t generation = conn->generation.load(memory_order_relaxed);
+    {
+        lock_guard<mutex> lock(mutex_);
+        conn_ = conn;
+        generation_ = generation;
+    }
+    if (connect_timeout_ms_ > 0) {
+        timeout_timer_ = loop->runAfter(connect_timeout_ms_, [this, conn, generation]() {
+            handleTimeout(conn, generation);
+        });
+    }
+}
+
+void TcpClient::handleConnect(Connection *conn, int err) {
+    timeout_timer_.cancel();
+    if (err != 0) {
+        loop_->disConnect(conn);
+        retryLater("failed to connect to " + addr_info_.toString() + ": " + strerror(err));
+        return;
+    }
+    {
+        lock_guard<mutex> lock(mutex_);
+        connected_ = true;
+    }
+    retry_delay_ms_ = retry_initial_ms_;
+    if (connection_cb_ != nullptr) {
+        connection_cb_(Socket(conn->fd, conn->addr_info), true, this);
+    }
+}
+
+void TcpClient::handleTimeout(Connection *conn, uint32_t generation) {
+    if (!loop_->owns(conn, generation) || !conn->connecting) {
+        return;
+    }
+    loop_->disConnect(conn);
+    retryLater("connecting to " + addr_info_.toString() + " timed out");
+}
+
+void TcpClient::handleClose(Connection *conn) {
+    uint32_t generation = conn->generation.load(memory_order_relaxed);
+    if (!conn->connecting && connection_cb_ != nullptr) {
+        connection_cb_(Socket(conn->fd, conn->addr_info), false, this);
+    }
+    // 回调中可能已经断开了连接
+    if (loop_->owns(conn, generation)) {
+        loop_->disConnect(conn);
+    }
+    retryLater("the connection to " + addr_info_.toString() + " was closed");
+}
+
+void TcpClient::handleRelease(Connection *conn) {
+    if (conn != conn_) {
+        return;
+    }
+    timeout_timer_.cancel();
+    lock_guard<mutex> lock(mutex_);
+    conn_ = nullptr;
+    connected_ = false;
+}
+
+void TcpClient::retryLater(const string &error) {
+    {
+        lock_guard<mutex> lock(mutex_);
+        error_ = error;
+    }
+    if (!retry_ || stopped_.load(memory_order_acquire)) {
+        return;
+    }
+    int delay_ms = retry_delay_ms_;
+    retry_delay_ms_ = delay_ms > retry_max_ms_ / 2 ? retry_max_ms_ : delay_ms * 2;
+    retry_timer_ = loop_->runAfter(delay_ms, [this]() {
+        startConnect();
+    });
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include "TcpServer.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <atomic>
+#include <mutex>
+
+namespace CwNetWork {
+
+    /*
+     * 运行在TcpServer主事件循环上的非阻塞Tcp客户端，用于向上游服务发起的长连接与客户端连接共用Reactor
+     * 连接以非阻塞connect发起，握手完成前只关心可写事件；连接失败、超时或建立后断开时按指数退避重新连接。
+     * 连接使用与服务端连接相同的连接槽、接收缓冲区和发送缓冲区，但不计入服务端的连接数，
+     * 也不参与广播、空闲超时、排空和热升级移交；服务端设置的写停滞超时同样作用于该连接
+     */
+    class TcpClient {
+
+    public:
+
+        /*
+         * 接收数据的回调函数
+         * void(Socket, const char *, size_t, TcpClient *const)
+         * Socket: 连接的Socket对象  const char *: 消息起始地址  size_t: 消息长度  TcpClient *const: Tcp客户端
+         */
+        using MessageCallBack = std::function<void(Socket, const char *, size_t, TcpClient *const)>;
+
+        /*
+         * 连接建立或断开的回调函数
+         * void(const Socket &, bool, TcpClient *const)
+         * const Socket &: 连接的Socket对象  bool: true为已建立、false为已断开  TcpClient *const: Tcp客户端
+         */
+        using ConnectionCallBack = std::function<void(const Socket &, bool, TcpClient *const)>;
+
+        /**
+          * @brief  构造一个向指定地址发起连接的Tcp客户端
+          * @note   连接在TcpServer的主事件循环中建立和收发；客户端必须在服务端运行期间保持存活
+          * @param  _1:所属的Tcp服务端 _2:要连接的网络地址
+          */
+        TcpClient(TcpServer *, const AddrInfo &);
+
+        TcpClient(const TcpClient &) = delete;
+
+        TcpClient &operator=(const TcpClient &) = delete;
+
+        /**
+          * @brief  设置接收数据的回调函数
+          * @note   设置了编解码器时逐帧交付；必须在connect之前设置
+          * @param  MessageCallBack => void(Socket, const char *, size_t, TcpClient *const)
+          */
+        void setMessageCallBack(MessageCallBack message_callback) { message_cb_ = std::move(message_callback); }
+
+        /**
+          * @brief  设置连接建立和断开的回调函数
+          * @note   连接建立后以true调用；已建立的连接被对端关闭、出错或写停滞超时断开时以false调用，回调返回后才释放连接。
+          *         连接失败和调用disconnect不会以false调用。必须在connect之前设置
+          * @param  ConnectionCallBack => void(const Socket &, bool, TcpClient *const)
+          */
+        void setConnectionCallBack(ConnectionCallBack connection_callback) {
+            connection_cb_ = std::move(connection_callback);
+        }
+
+        /**
+          * @brief  设置编解码器，接收的数据按帧交付，sendFrame按帧发送
+          * @note   必须在connect之前设置
+          * @param  编解码器，为空时关闭
+          */
+        void setCodec(std::shared_ptr<Codec> codec) { codec_ = std::move(codec); }
+
+        /**
+          * @brief  设置作用于该客户端套接字的选项
+          * @note   在connect之前应用，Unix域套接字不应用；必须在connect之前设置
+          * @param  套接字选项
+          */
+        void setSocketOptions(const SocketOptions &options) { socket_options_ = options; }
+
+        /**
+          * @brief  设置连接超时，握手在该时长内未完成时放弃本次连接
+          * @note   默认3000毫秒；必须在connect之前设置
+          * @param  超时毫秒数，不大于0表示只受内核SYN重传次数限制
+          */
+        void setConnectTimeout(int timeout_ms) { connect_timeout_ms_ = timeout_ms; }
+
+        /**
+          * @brief  设置断线重连
+          * @note   默认开启；每次连接失败后等待时长翻倍，直到上限，连接建立后恢复为初始值。必须在connect之前设置
+          * @param  _1:是否重连 _2:首次重连前等待的毫秒数 _3:等待毫秒数的上限
+          */
+        void setRetry(bool enable, int initial_delay_ms = 500, int max_delay_ms = 30000) {
+            retry_ = enable;
+            retry_initial_ms_ = initial_delay_ms > 0 ? initial_delay_ms : 1;
+            retry_max_ms_ = max_delay_ms > retry_initial_ms_ ? max_delay_ms : retry_initial_ms_;
+        }
+
+        /**
+          * @brief  发起连接
+          * @note   线程安全，服务端运行前调用时在run启动后连接；已连接或正在连接时什么也不做
+          */
+        void connect();
+
+        /**
+          * @brief  断开连接并停止重连
+          * @note   线程安全，发送缓冲区中尚未写出的数据被丢弃，不执行连接断开回调；之后可再次调用connect
+          */
+        void disconnect();
+
+        /**
+          * @brief  发送数据
+          * @note   线程安全，在其他线程中调用时数据将被复制并投递到主事件循环中发送
+          * @param  要发送的数据
+          * @retval 连接尚未建立时返回false，数据被丢弃
+          */
+        bool send(const std::string &);
+
+        /**
+          * @brief  使用编解码器将消息编码为一帧后发送
+          * @note   未设置编解码器时等同于send；消息无法编码为一帧时抛出编解码器的异常；线程安全
+          * @param  要发送的消息
+          * @retval 连接尚未建立时返回false，消息被丢弃
+          */
+        bool sendFrame(const std::string &message) { return send(codec_ != nullptr ? codec_->encode(message) : message); }
+
+        /**
+          * @brief  判断连接是否已建立
+          * @note   线程安全
+          * @retval 是否已建立
+          */
+        bool isConnected() const;
+
+        /**
+          * @brief  获取要连接的网络地址
+          * @retval 网络地址
+          */
+        const AddrInfo &getAddress() const { return addr_info_; }
+
+        /**
+          * @brief  获取所属的Tcp服务端
+          * @retval TcpServer指针
+          */
+        TcpServer *getTcpServer() const { return server_; }
+
+        /**
+          * @brief  获取最近一次连接失败的原因
+          * @note   线程安全
+          * @retval 连接失败原因的描述
+          */
+        std::string getError() const;
+
+    private:
+
+        friend class EventLoop;
+
+        /**
+          * @brief  创建非阻塞套接字并发起连接，握手结果由事件循环通过handleConnect交回
+          * @note   在主事件循环线程中执行
+          */
+        void startConnect();
+
+        /**
+          * @brief  处理握手结果，成功时执行连接建立回调，失败时释放连接并安排重连
+          * @param  _1:连接 _2:SO_ERROR中的错误码，0表示成功
+          */
+        void handleConnect(Connection *, int);
+
+        /**
+          * @brief  处理连接超时，仍在握手时释放连接并安排重连
+          * @param  _1:连接 _2:发起连接时的槽位代数
+          */
+        void handleTimeout(Connection *, uint32_t);
+
+        /**
+          * @brief  处理已建立连接的断开，执行连接断开回调、释放连接并安排重连
+          * @param  连接
+          */
+        void handleClose(Connection *);
+
+        /**
+          * @brief  连接被事件循环释放时清除该客户端持有的连接
+          * @param  连接
+          */
+        void handleRelease(Connection *);
+
+        /**
+          * @brief  记录连接失败原因，未调用disconnect且开启了重连时按当前退避时长安排下一次连接
+          * @param  连接失败原因
+          */
+        void retryLater(const std::string &);
+
+        // 所属的Tcp服务端
+        TcpServer *server_;
+        // 要连接的网络地址
+        AddrInfo addr_info_;
+        // 接收数据的回调函数
+        MessageCallBack message_cb_ = nullptr;
+        // 连接建立和断开的回调函数
+        ConnectionCallBack connection_cb_ = nullptr;
+        // 编解码器
+        std::shared_ptr<Codec> codec_;
+        // 作用于客户端套接字的选项
+        SocketOptions socket_options_;
+        // 连接超时毫秒数
+        int connect_timeout_ms_ = 3000;
+        // 是否断线重连
+        bool retry_ = true;
+        // 首次重连前等待的毫秒数
+        int retry_initial_ms_ = 500;
+        // 重连等待毫秒数的上限
+        int retry_max_ms_ = 30000;
+        // 下一次重连前等待的毫秒数
+        int retry_delay_ms_ = 500;
+        // 是否已调用disconnect
+        std::atomic<bool> stopped_{true};
+        // 连接超时定时器
+        TimerId timeout_timer_;
+        // 重连定时器
+        TimerId retry_timer_;
+        // 保护以下成员，它们只由主事件循环线程修改，可被其他线程读取
+        mutable std::mutex mutex_;
+        // 连接所属的事件循环
+        EventLoop *loop_ = nullptr;
+        // 正在连接或已建立的连接，没有时为nullptr
+        Connection *conn_ = nullptr;
+        // 连接的槽位代数
+        uint32_t generation_ = 0;
+        // 连接是否已建立
+        bool connected_ = false;
+        // 最近一次连接失败的原因
+        std::string error_;
+
+    };
+
+}
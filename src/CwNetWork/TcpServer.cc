@@ -1,17 +1,42 @@
 #include "TcpServer.h"
-#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
 #include <utility>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 
 using namespace std;
 using namespace CwNetWork;
 
+// 连接槽可管理的最大文件描述符数量，超出该范围的连接将被拒绝
+static const rlim_t kMaxFdTableSize = 1 << 24;
+
+struct TcpServer::Handover {
+    Handover(int fd, size_t loop_num) : channel(fd), remaining(loop_num) {}
+
+    // 与新进程连接的通道
+    UpgradeChannel channel;
+    // 保护以下成员
+    std::mutex mutex;
+    // 已汇总的服务端套接字
+    vector<int> listen_fds;
+    // 已汇总的连接
+    vector<HandoffConnection> conns;
+    // 尚未完成导出的事件循环数
+    size_t remaining;
+};
+
 TcpServer::TcpServer() {
     accept_cb_ = acceptCallBack;
 }
 
 TcpServer::TcpServer(unsigned short port, RecvCallBack recv_cb, size_t rbuf_size)
         : TcpServer() {
-    port_ = port;
+    listen_addr_ = AddrInfo::anyAddress(port);
     recv_cb_ = std::move(recv_cb);
     rbuf_size_ = rbuf_size;
 }
@@ -26,99 +51,548 @@ TcpServer::TcpServer(unsigned short port, RecvCallBack recv_cb, AcceptCallBack a
     backlog_ = backlog;
 }
 
-TcpServer::~TcpServer() {
-    server_socket_.closeFd();
-    epoll_.freeEpoll();
-    delete[]rbuf_;
-}
+TcpServer::~TcpServer() = default;
 
 void TcpServer::sendAll(int fd, const string &message) {
-    string all = clients_sbuf_.at(fd).append(message);
-    ssize_t slen = send(fd, all.c_str(), all.size(), 0);
-    if (slen != -1) {
-        clients_sbuf_.at(fd).erase(0, slen);
+    EventLoop *loop = nullptr;
+    uint32_t generation = 0;
+    Connection *conn = connectionOf(fd, loop, generation);
+    if (loop->isInLoopThread()) {
+        loop->sendAll(conn, message);
+        return;
+    }
+    loop->queueInLoop([loop, conn, generation, message]() {
+        if (loop->owns(conn, generation)) {
+            loop->sendAll(conn, message);
+        }
+    });
+}
+
+bool TcpServer::sendFile(int fd, int file_fd, off_t offset, size_t len) {
+    EventLoop *loop = nullptr;
+    uint32_t generation = 0;
+    Connection *conn = connectionOf(fd, loop, generation);
+    if (len == 0) {
+        struct stat st{};
+        if (fstat(file_fd, &st) == -1 || st.st_size <= offset) {
+            return false;
+        }
+        len = static_cast<size_t>(st.st_size - offset);
+    }
+    int dup_fd = fcntl(file_fd, F_DUPFD_CLOEXEC, 0);
+    if (dup_fd == -1) {
+        return false;
+    }
+    if (loop->isInLoopThread()) {
+        loop->sendFile(conn, dup_fd, offset, len);
+        return true;
+    }
+    loop->queueInLoop([loop, conn, generation, dup_fd, offset, len]() {
+        if (loop->owns(conn, generation)) {
+            loop->sendFile(conn, dup_fd, offset, len);
+        } else {
+            close(dup_fd);
+        }
+    });
+    return true;
+}
+
+bool TcpServer::sendPipe(int fd, int pipe_fd, size_t len) {
+    EventLoop *loop = nullptr;
+    uint32_t generation = 0;
+    Connection *conn = connectionOf(fd, loop, generation);
+    int dup_fd = fcntl(pipe_fd, F_DUPFD_CLOEXEC, 0);
+    if (dup_fd == -1) {
+        return false;
+    }
+    if (loop->isInLoopThread()) {
+        loop->sendPipe(conn, dup_fd, len);
+        return true;
+    }
+    loop->queueInLoop([loop, conn, generation, dup_fd, len]() {
+        if (loop->owns(conn, generation)) {
+            loop->sendPipe(conn, dup_fd, len);
+        } else {
+            close(dup_fd);
+        }
+    });
+    return true;
+}
+
+void TcpServer::broadcast(const string &message, BroadcastFilter filter) {
+    if (!running_.load(memory_order_acquire) || message.empty()) {
+        return;
+    }
+    auto chunk = make_shared<const string>(message);
+    auto shared_filter = make_shared<const BroadcastFilter>(std::move(filter));
+    for (auto &loop: loops_) {
+        EventLoop *target = loop.get();
+        target->runInLoop([target, chunk, shared_filter]() {
+            target->broadcast(chunk, *shared_filter);
+        });
+    }
+}
+
+void TcpServer::broadcast(const string &message, const vector<int> &fds) {
+    if (!running_.load(memory_order_acquire) || message.empty()) {
+        return;
+    }
+    unordered_map<EventLoop *, vector<EventLoop::Target>> groups;
+    for (int fd: fds) {
+        EventLoop *loop = nullptr;
+        uint32_t generation = 0;
+        Connection *conn = findConnection(fd, loop, generation);
+        if (conn != nullptr) {
+            groups[loop].emplace_back(conn, generation);
+        }
+    }
+    auto chunk = make_shared<const string>(message);
+    for (auto &group: groups) {
+        EventLoop *target = group.first;
+        if (target->isInLoopThread()) {
+            target->broadcast(chunk, group.second);
+            continue;
+        }
+        auto targets = make_shared<vector<EventLoop::Target>>(std::move(group.second));
+        target->queueInLoop([target, chunk, targets]() {
+            target->broadcast(chunk, *targets);
+        });
+    }
+}
+
+uint64_t TcpServer::getSessionId(const Socket &client) const {
+    EventLoop *loop = nullptr;
+    uint32_t generation = 0;
+    Connection *conn = connectionOf(client.getFd(), loop, generation);
+    uint32_t session = conn->session.load(memory_order_acquire);
+    if (conn->generation.load(memory_order_acquire) != generation) {
+        throw out_of_range("the client does not belong to any event loop");
+    }
+    return static_cast<uint64_t>(session) << 32 | static_cast<uint32_t>(client.getFd());
+}
+
+void TcpServer::setContext(const Socket &client, shared_ptr<void> context) {
+    localConnection(client.getFd())->context = std::move(context);
+}
+
+const shared_ptr<void> &TcpServer::getContext(const Socket &client) const {
+    return localConnection(client.getFd())->context;
+}
+
+size_t TcpServer::touchSessions(const vector<uint64_t> &sessions) {
+    unordered_map<EventLoop *, vector<EventLoop::Target>> groups;
+    size_t alive = 0;
+    for (uint64_t session: sessions) {
+        EventLoop *loop = nullptr;
+        uint32_t generation = 0;
+        Connection *conn = findSession(session, loop, generation);
+        if (conn != nullptr) {
+            groups[loop].emplace_back(conn, generation);
+            ++alive;
+        }
+    }
+    for (auto &group: groups) {
+        EventLoop *target = group.first;
+        if (target->isInLoopThread()) {
+            target->touch(group.second);
+            continue;
+        }
+        auto targets = make_shared<vector<EventLoop::Target>>(std::move(group.second));
+        target->queueInLoop([target, targets]() {
+            target->touch(*targets);
+        });
     }
+    return alive;
+}
+
+TimerId TcpServer::addTimer(shared_ptr<Timer> timer) {
+    TimerId id(timer);
+    lock_guard<mutex> lock(timer_mutex_);
+    if (running_.load(memory_order_acquire)) {
+        loops_[0]->addTimer(std::move(timer));
+    } else {
+        pending_timers_.push_back(std::move(timer));
+    }
+    return id;
+}
+
+unordered_map<int, Socket> TcpServer::getClients() const {
+    unordered_map<int, Socket> clients;
+    for (auto &loop: loops_) {
+        unordered_map<int, Socket> loop_clients = loop->getClients();
+        clients.insert(loop_clients.begin(), loop_clients.end());
+    }
+    return clients;
 }
 
 bool TcpServer::run() {
     if (!initServer()) {
         return false;
     }
-    int ev_num = 0, i = 0, fd = 0;
-    while (true) {
-        ev_num = epoll_.wait(-1);
-        for (i = 0; i < ev_num; ++i) {
-            fd = epoll_[i].data.fd;
-            if (fd == server_socket_.getFd()) {
-                Socket client = acceptCallBack(server_socket_);
-                client.setNonBlock();
-                epoll_.add(client.getFd(), EPOLLIN | EPOLLOUT | EPOLLET);
-                clients_.emplace(client.getFd(), client);
-                clients_sbuf_.emplace(client.getFd(), string());
-            } else if (epoll_[i].events & EPOLLIN) {
-                string message;
-                ssize_t rlen = 0;
-                while (true) {
-                    rlen = recv(fd, rbuf_, rbuf_size_, 0);
-                    if (rlen == -1 && errno == EAGAIN) {
-                        recv_cb_(clients_.at(fd), message, this);
-                        break;
-                    } else if (rlen == 0 || rlen == -1) {
-                        Socket client = clients_.at(fd);
-                        if (close_cb_ != nullptr) {
-                            close_cb_(client, this);
-                        }
-                        epoll_.del(fd);
-                        client.closeFd();
-                        clients_.erase(fd);
-                        break;
-                    }
-                    message.append(rbuf_, rlen);
-                }
-            } else if (epoll_[i].events & EPOLLOUT) {
-                string message = clients_sbuf_.at(fd);
-                ssize_t slen = send(fd, message.c_str(), message.size(), 0);
-                clients_sbuf_.at(fd).erase(0, slen);
-            }
+    {
+        lock_guard<mutex> lock(timer_mutex_);
+        running_.store(true, memory_order_release);
+        for (auto &timer: pending_timers_) {
+            loops_[0]->addTimer(std::move(timer));
         }
+        pending_timers_.clear();
     }
+    adoptInherited();
+    vector<thread> threads;
+    size_t first = acceptor_ != nullptr ? 0 : 1;
+    for (size_t i = first; i < loops_.size(); ++i) {
+        threads.emplace_back([this, i]() { loops_[i]->loop(); });
+    }
+    if (acceptor_ != nullptr) {
+        acceptor_->loop();
+    } else {
+        loops_[0]->loop();
+    }
+    for (auto &t: threads) {
+        t.join();
+    }
+    lock_guard<mutex> lock(timer_mutex_);
+    running_.store(false, memory_order_release);
     return true;
 }
 
+void TcpServer::stop() {
+    if (!running_.load(memory_order_acquire)) {
+        return;
+    }
+    if (acceptor_ != nullptr) {
+        acceptor_->quit();
+    }
+    for (auto &loop: loops_) {
+        loop->quit();
+    }
+}
+
+void TcpServer::drain(int timeout_ms) {
+    if (!running_.load(memory_order_acquire)) {
+        return;
+    }
+    if (acceptor_ != nullptr) {
+        acceptor_->drain(timeout_ms);
+    }
+    for (auto &loop: loops_) {
+        loop->drain(timeout_ms);
+    }
+}
+
 bool TcpServer::initServer() {
     error_ = "the server is running normally";
-    rbuf_ = new char[rbuf_size_];
-    bzero(rbuf_, rbuf_size_);
-    if (recv_cb_ == nullptr || accept_cb_ == nullptr) {
+    if ((recv_cb_ == nullptr && message_cb_ == nullptr) || accept_cb_ == nullptr) {
         error_ = "the callback functions for receiving messages and accepting connections are not set";
         return false;
     }
-    if (!server_socket_.setSockReuable()) {
-        error_ = "the port multiplexing setting failed";
+    if (listen_addr_.getFamily() == AF_UNSPEC) {
+        error_ = "the listen address is invalid";
         return false;
     }
-    if (!server_socket_.serverBind(port_)) {
-        error_ = "failed to bind the port";
+    if (listen_addr_.getFamily() == AF_UNIX && accept_mode_ == AcceptMode::REUSE_PORT && loop_num_ > 1) {
+        // 多个服务端套接字无法绑定同一路径，改由一个接受连接事件循环分发
+        accept_mode_ = AcceptMode::ACCEPTOR;
+    }
+    // sendfile和splice没有MSG_NOSIGNAL，对端关闭时会产生SIGPIPE；不覆盖使用者已设置的处理函数
+    struct sigaction action{};
+    if (sigaction(SIGPIPE, nullptr, &action) == 0 && action.sa_handler == SIG_DFL) {
+        signal(SIGPIPE, SIG_IGN);
+    }
+    if (socket_options_.hasConnectionOptions()) {
+        // 连接选项对每个新连接静默应用，先在临时套接字上试设一次以便及早发现不支持的选项
+        Socket probe = Socket::newSocket();
+        string option;
+        bool applied = socket_options_.applyToAccepted(probe, option);
+        probe.closeFd();
+        if (!applied) {
+            error_ = "failed to set the socket option " + option;
+            return false;
+        }
+    }
+    struct rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == -1 || limit.rlim_cur > kMaxFdTableSize) {
+        limit.rlim_cur = kMaxFdTableSize;
+    }
+    loops_.clear();
+    acceptor_.reset();
+    // 旧连接槽中的接收缓冲区可能仍借用着旧池的块，先析构连接槽再替换池
+    slab_.reset();
+    buffer_pool_.reset();
+    if (buffer_pool_enabled_) {
+        buffer_pool_.reset(new BufferPool(rbuf_size_ + Buffer::kCheapPrepend, buffer_pool_max_blocks_,
+                                          buffer_pool_huge_pages_));
+    }
+    slab_.reset(new ConnectionSlab(limit.rlim_cur));
+    for (size_t i = 0; i < loop_num_; ++i) {
+        loops_.emplace_back(new EventLoop(this, rbuf_size_));
+        if (!loops_.back()->init()) {
+            error_ = loops_.back()->getError();
+            loops_.clear();
+            return false;
+        }
+    }
+    if (accept_mode_ == AcceptMode::ACCEPTOR) {
+        acceptor_.reset(new EventLoop(this, 0));
+        if (!acceptor_->init()) {
+            error_ = acceptor_->getError();
+            acceptor_.reset();
+            loops_.clear();
+            return false;
+        }
+    }
+    // 旧进程仍持有端口，必须先接管它的服务端套接字再监听
+    if (!upgrade_path_.empty() && !takeOver()) {
+        acceptor_.reset();
+        loops_.clear();
         return false;
     }
-    if (!server_socket_.serverListen(backlog_)) {
-        error_ = "listening failed";
+    bool reuse_port = accept_mode_ == AcceptMode::REUSE_PORT && loop_num_ > 1;
+    EventLoop *failed = nullptr;
+    if (accept_mode_ == AcceptMode::REUSE_PORT) {
+        for (auto &loop: loops_) {
+            if (!loop->listen(listen_addr_, socket_type_, backlog_, reuse_port)) {
+                failed = loop.get();
+                break;
+            }
+        }
+    } else if (!acceptor_->listen(listen_addr_, socket_type_, backlog_, false)) {
+        failed = acceptor_.get();
+    }
+    if (failed == nullptr && !upgrade_path_.empty() && !loops_[0]->listenUpgrade(upgrade_path_)) {
+        failed = loops_[0].get();
+    }
+    if (failed != nullptr) {
+        error_ = failed->getError();
+        releaseInherited();
+        acceptor_.reset();
+        loops_.clear();
         return false;
     }
-    if (!epoll_.add(server_socket_.getFd(), EPOLLIN)) {
-        error_ = "failed to add server-side sockets to the epoll model";
+    // 新进程的服务端套接字少于旧进程时，多出的继承套接字及其等待队列中的连接只能放弃
+    for (int fd: inherited_listeners_) {
+        close(fd);
+    }
+    inherited_listeners_.clear();
+    return true;
+}
+
+bool TcpServer::takeOver() {
+    inherited_listeners_.clear();
+    inherited_conns_.clear();
+    int fd = UpgradeChannel::connect(upgrade_path_);
+    if (fd == -1) {
+        return true;
+    }
+    UpgradeChannel channel(fd);
+    if (!channel.receive(inherited_listeners_, inherited_conns_)) {
+        error_ = "failed to take over from the previous process";
         return false;
     }
     return true;
 }
 
+int TcpServer::takeInheritedListener() {
+    if (inherited_listeners_.empty()) {
+        return -1;
+    }
+    int fd = inherited_listeners_.front();
+    inherited_listeners_.erase(inherited_listeners_.begin());
+    return fd;
+}
+
+void TcpServer::adoptInherited() {
+    for (size_t i = 0; i < inherited_conns_.size(); ++i) {
+        HandoffConnection &handoff = inherited_conns_[i];
+        if (loops_[i % loops_.size()]->adoptClient(handoff) && upgrade_restore_cb_ != nullptr) {
+            upgrade_restore_cb_(Socket(handoff.fd, handoff.addr_info), handoff.state, this);
+        }
+    }
+    inherited_conns_.clear();
+}
+
+void TcpServer::releaseInherited() {
+    for (int fd: inherited_listeners_) {
+        close(fd);
+    }
+    for (auto &handoff: inherited_conns_) {
+        close(handoff.fd);
+        for (auto &segment: handoff.output) {
+            if (segment.fd != -1) {
+                close(segment.fd);
+            }
+        }
+    }
+    inherited_listeners_.clear();
+    inherited_conns_.clear();
+}
+
+void TcpServer::handOver(int channel_fd) {
+    vector<EventLoop *> loops = allLoops();
+    auto handover = make_shared<Handover>(channel_fd, loops.size());
+    for (EventLoop *loop: loops) {
+        loop->runInLoop([this, loop, handover]() {
+            vector<int> listen_fds;
+            vector<HandoffConnection> conns;
+            loop->handOver(listen_fds, conns);
+            collectHandover(*handover, listen_fds, conns);
+        });
+    }
+}
+
+void TcpServer::collectHandover(Handover &handover, vector<int> &listen_fds, vector<HandoffConnection> &conns) {
+    {
+        lock_guard<mutex> lock(handover.mutex);
+        handover.listen_fds.insert(handover.listen_fds.end(), listen_fds.begin(), listen_fds.end());
+        handover.conns.insert(handover.conns.end(), make_move_iterator(conns.begin()),
+                              make_move_iterator(conns.end()));
+        if (--handover.remaining > 0) {
+            return;
+        }
+    }
+    // 全部事件循环都已导出，此后不会再有线程访问共享状态
+    bool handed_over = handover.channel.sendListeners(handover.listen_fds) &&
+                       handover.channel.sendConnections(handover.conns) && handover.channel.finish();
+    for (EventLoop *loop: allLoops()) {
+        if (handed_over) {
+            loop->quit();
+        } else {
+            loop->runInLoop([loop]() { loop->resume(); });
+        }
+    }
+    if (!handed_over) {
+        EventLoop *base = loops_[0].get();
+        base->runInLoop([this, base]() { base->listenUpgrade(upgrade_path_); });
+    }
+}
+
+size_t TcpServer::getConnectionCount() const {
+    if (!running_.load(memory_order_acquire)) {
+        return 0;
+    }
+    size_t count = 0;
+    for (auto &loop: loops_) {
+        count += loop->getConnectionCount();
+    }
+    return count;
+}
+
+void TcpServer::resumeAccepting() {
+    if (max_connections_ > 0 && getConnectionCount() >= max_connections_) {
+        return;
+    }
+    for (EventLoop *loop: allLoops()) {
+        loop->wakeAccept();
+    }
+}
+
+vector<EventLoop *> TcpServer::allLoops() const {
+    vector<EventLoop *> loops;
+    for (auto &loop: loops_) {
+        loops.push_back(loop.get());
+    }
+    if (acceptor_ != nullptr) {
+        loops.push_back(acceptor_.get());
+    }
+    return loops;
+}
+
+Socket TcpServer::acceptClient(const ServerSocket &server_socket) {
+    if (defaultAccept()) {
+        return server_socket.serverAccept(SOCK_NONBLOCK | SOCK_CLOEXEC);
+    }
+    Socket client = accept_cb_(server_socket);
+    if (client.getFd() != -1) {
+        client.setNonBlock();
+    }
+    return client;
+}
+
+bool TcpServer::defaultAccept() const {
+    auto callback = accept_cb_.target<Socket (*)(const ServerSocket &)>();
+    return callback != nullptr && *callback == acceptCallBack;
+}
+
+EventLoop *TcpServer::selectLoop(EventLoop *acceptor) {
+    if (acceptor != acceptor_.get()) {
+        return acceptor;
+    }
+    if (dispatch_policy_ == DispatchPolicy::LEAST_LOADED) {
+        EventLoop *target = loops_[0].get();
+        for (auto &loop: loops_) {
+            if (loop->getConnectionCount() < target->getConnectionCount()) {
+                target = loop.get();
+            }
+        }
+        return target;
+    }
+    EventLoop *target = loops_[next_loop_].get();
+    next_loop_ = (next_loop_ + 1) % loops_.size();
+    return target;
+}
+
 Socket TcpServer::acceptCallBack(const ServerSocket &server_socket) {
     return server_socket.serverAccept();
 }
 
 void TcpServer::disConnect(int client_fd) {
-    epoll_.del(client_fd);
-    clients_.at(client_fd).closeFd();
-    clients_.erase(client_fd);
-    clients_sbuf_.erase(client_fd);
+    EventLoop *loop = nullptr;
+    uint32_t generation = 0;
+    Connection *conn = connectionOf(client_fd, loop, generation);
+    if (loop->isInLoopThread()) {
+        loop->disConnect(conn);
+        return;
+    }
+    loop->queueInLoop([loop, conn, generation]() {
+        if (loop->owns(conn, generation)) {
+            loop->disConnect(conn);
+        }
+    });
+}
+
+Connection *TcpServer::connectionOf(int fd, EventLoop *&loop, uint32_t &generation) const {
+    Connection *conn = findConnection(fd, loop, generation);
+    if (conn == nullptr) {
+        throw out_of_range("the client does not belong to any event loop");
+    }
+    return conn;
+}
+
+Connection *TcpServer::localConnection(int fd) const {
+    EventLoop *current = EventLoop::current();
+    Connection *conn = current != nullptr && slab_ != nullptr ? slab_->get(fd) : nullptr;
+    if (conn == nullptr || conn->loop.load(memory_order_relaxed) != current) {
+        throw out_of_range("the client does not belong to the event loop of this thread");
+    }
+    return conn;
+}
+
+Connection *TcpServer::findConnection(int fd, EventLoop *&loop, uint32_t &generation) const {
+    Connection *conn = running_.load(memory_order_acquire) ? slab_->get(fd) : nullptr;
+    if (conn == nullptr) {
+        return nullptr;
+    }
+    do {
+        generation = conn->generation.load(memory_order_acquire);
+        loop = conn->loop.load(memory_order_acquire);
+    } while (loop != nullptr && conn->generation.load(memory_order_acquire) != generation);
+    return loop != nullptr ? conn : nullptr;
+}
+
+Connection *TcpServer::findSession(uint64_t session, EventLoop *&loop, uint32_t &generation) const {
+    auto fd = static_cast<int>(session & 0x7fffffff);
+    auto nonce = static_cast<uint32_t>(session >> 32);
+    Connection *conn = findConnection(fd, loop, generation);
+    if (conn == nullptr || nonce == 0 || conn->session.load(memory_order_acquire) != nonce) {
+        return nullptr;
+    }
+    // 读取随机数期间连接可能被关闭并复用
+    return conn->generation.load(memory_order_acquire) == generation ? conn : nullptr;
+}
+
+EventLoop *TcpServer::baseLoop() const {
+    if (!running_.load(memory_order_acquire)) {
+        throw runtime_error("the server is not running");
+    }
+    return loops_[0].get();
 }
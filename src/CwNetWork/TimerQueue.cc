@@ -0,0 +1,125 @@
+#include "TimerQueue.h"
+#include <algorithm>
+#include <ctime>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+using namespace std;
+using namespace CwNetWork;
+
+// 定时器创建序号
+static atomic<uint64_t> next_seq{0};
+
+void TimerId::cancel() const {
+    shared_ptr<Timer> timer = timer_.lock();
+    if (timer != nullptr) {
+        timer->cancelled.store(true, memory_order_release);
+    }
+}
+
+bool TimerId::active() const {
+    shared_ptr<Timer> timer = timer_.lock();
+    return timer != nullptr && !timer->cancelled.load(memory_order_acquire);
+}
+
+TimerQueue::~TimerQueue() {
+    if (timer_fd_ != -1) {
+        close(timer_fd_);
+    }
+}
+
+bool TimerQueue::init() {
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    return timer_fd_ != -1;
+}
+
+int64_t TimerQueue::now() {
+    struct timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+shared_ptr<Timer> TimerQueue::newTimer(int delay_ms, int interval_ms, function<void()> cb) {
+    auto timer = make_shared<Timer>();
+    timer->cb = std::move(cb);
+    timer->when = now() + max(delay_ms, 0);
+    timer->interval = max(interval_ms, 0);
+    timer->seq = next_seq.fetch_add(1, memory_order_relaxed);
+    return timer;
+}
+
+void TimerQueue::insert(shared_ptr<Timer> timer) {
+    if (timer->cancelled.load(memory_order_acquire)) {
+        return;
+    }
+    int64_t when = timer->when;
+    heap_.push_back(std::move(timer));
+    push_heap(heap_.begin(), heap_.end(), laterThan);
+    if (heap_.size() >= compact_at_) {
+        compact();
+    }
+    if (armed_when_ == 0 || when < armed_when_) {
+        arm();
+    }
+}
+
+void TimerQueue::handleRead() {
+    uint64_t expirations = 0;
+    read(timer_fd_, &expirations, sizeof(expirations));
+    armed_when_ = 0;
+    int64_t now = TimerQueue::now();
+    uint64_t seq_end = next_seq.load(memory_order_relaxed);
+    vector<shared_ptr<Timer>> periodic;
+    while (!heap_.empty() && heap_.front()->when <= now && heap_.front()->seq < seq_end) {
+        shared_ptr<Timer> timer = pop();
+        if (timer->cancelled.load(memory_order_acquire)) {
+            continue;
+        }
+        timer->cb();
+        if (timer->interval > 0 && !timer->cancelled.load(memory_order_acquire)) {
+            // 回调耗时超过周期时从当前时刻重新计时，不补执行错过的次数
+            timer->when = max(timer->when + timer->interval, now + 1);
+            periodic.push_back(std::move(timer));
+        }
+    }
+    for (auto &timer: periodic) {
+        heap_.push_back(std::move(timer));
+        push_heap(heap_.begin(), heap_.end(), laterThan);
+    }
+    // 已取消的定时器到达堆顶时直接移除，避免为它们唤醒事件循环
+    while (!heap_.empty() && heap_.front()->cancelled.load(memory_order_acquire)) {
+        pop();
+    }
+    arm();
+}
+
+bool TimerQueue::laterThan(const shared_ptr<Timer> &lhs, const shared_ptr<Timer> &rhs) {
+    return lhs->when != rhs->when ? lhs->when > rhs->when : lhs->seq > rhs->seq;
+}
+
+shared_ptr<Timer> TimerQueue::pop() {
+    pop_heap(heap_.begin(), heap_.end(), laterThan);
+    shared_ptr<Timer> timer = std::move(heap_.back());
+    heap_.pop_back();
+    return timer;
+}
+
+void TimerQueue::compact() {
+    heap_.erase(remove_if(heap_.begin(), heap_.end(), [](const shared_ptr<Timer> &timer) {
+        return timer->cancelled.load(memory_order_acquire);
+    }), heap_.end());
+    make_heap(heap_.begin(), heap_.end(), laterThan);
+    compact_at_ = heap_.size() * 2 > kMinCompact ? heap_.size() * 2 : kMinCompact;
+}
+
+void TimerQueue::arm() {
+    int64_t when = heap_.empty() ? 0 : heap_.front()->when;
+    if (when == armed_when_) {
+        return;
+    }
+    struct itimerspec spec{};
+    spec.it_value.tv_sec = when / 1000;
+    spec.it_value.tv_nsec = (when % 1000) * 1000000;
+    timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+    armed_when_ = when;
+}
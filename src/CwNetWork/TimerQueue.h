@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+
+namespace CwNetWork {
+
+    /*
+     * 一个定时器，由所属事件循环的定时器队列持有，TimerId只持有其弱引用
+     */
+    struct Timer {
+        // 到期时执行的回调函数
+        std::function<void()> cb;
+        // 到期时间(单调时钟毫秒数)
+        int64_t when = 0;
+        // 周期毫秒数，0表示只执行一次
+        int64_t interval = 0;
+        // 创建序号，到期时间相同的定时器按创建的先后执行
+        uint64_t seq = 0;
+        // 是否已取消，可由任意线程设置
+        std::atomic<bool> cancelled{false};
+    };
+
+    /*
+     * 定时器句柄，可复制，用于在任意线程中取消定时器
+     */
+    class TimerId {
+
+    public:
+
+        TimerId() = default;
+
+        explicit TimerId(const std::shared_ptr<Timer> &timer) : timer_(timer) {}
+
+        /**
+          * @brief  取消定时器，已到期的一次性定时器和已取消的定时器什么也不做
+          * @note   线程安全；在事件循环线程中取消时回调不会再执行，其他线程中取消时正在到期的回调可能再执行一次
+          */
+        void cancel() const;
+
+        /**
+          * @brief  判断定时器是否仍在等待到期
+          * @retval 未取消且一次性定时器尚未执行完毕时为true
+          */
+        bool active() const;
+
+    private:
+
+        // 定时器，到期执行完毕或所属事件循环析构后失效
+        std::weak_ptr<Timer> timer_;
+
+    };
+
+    /*
+     * 以timerfd驱动的定时器小根堆，timerfd加入所属事件循环的Poller，始终按最早的到期时间设置
+     * 取消只做标记，被取消的定时器到达堆顶或堆大小翻倍时才被移除；除newTimer外只能在所属事件循环线程中调用
+     */
+    class TimerQueue {
+
+    public:
+
+        TimerQueue() = default;
+
+        ~TimerQueue();
+
+        TimerQueue(const TimerQueue &) = delete;
+
+        TimerQueue &operator=(const TimerQueue &) = delete;
+
+        /**
+          * @brief  创建timerfd
+          * @retval 是否成功
+          */
+        bool init();
+
+        /**
+          * @brief  获取timerfd，可读时应调用handleRead
+          * @retval timerfd
+          */
+        int getFd() const { return timer_fd_; }
+
+        /**
+          * @brief  创建一个从当前时刻开始计时的定时器，尚未加入任何定时器队列
+          * @note   线程安全
+          * @param  _1:延迟毫秒数 _2:周期毫秒数，0表示只执行一次 _3:回调函数
+          * @retval 定时器
+          */
+        static std::shared_ptr<Timer> newTimer(int delay_ms, int interval_ms, std::function<void()>);
+
+        /**
+          * @brief  获取单调时钟下的当前毫秒数，定时器的到期时间和事件循环的各项期限都以它计算
+          * @note   线程安全；clock_gettime是异步信号安全的，可在信号处理函数中调用
+          * @retval 毫秒数
+          */
+        static int64_t now();
+
+        /**
+          * @brief  将定时器加入队列，必要时提前timerfd的到期时间
+          * @param  定时器
+          */
+        void insert(std::shared_ptr<Timer>);
+
+        /**
+          * @brief  读取timerfd并执行全部已到期的定时器，周期定时器按周期重新加入
+          * @note   回调中新加入的已到期定时器留到下一轮执行，避免饿死IO事件
+          */
+        void handleRead();
+
+        /**
+          * @brief  获取队列中的定时器数量(含已取消但尚未移除的)
+          * @retval 定时器数量
+          */
+        size_t size() const { return heap_.size(); }
+
+    private:
+
+        // 触发移除已取消定时器的最小堆大小
+        static const size_t kMinCompact = 64;
+
+        /**
+          * @brief  小根堆的比较函数
+          * @param  _1:定时器 _2:定时器
+          * @retval _1是否晚于_2到期
+          */
+        static bool laterThan(const std::shared_ptr<Timer> &, const std::shared_ptr<Timer> &);
+
+        /**
+          * @brief  弹出堆顶的定时器
+          * @retval 堆顶的定时器
+          */
+        std::shared_ptr<Timer> pop();
+
+        /**
+          * @brief  移除堆中全部已取消的定时器并重建堆
+          */
+        void compact();
+
+        /**
+          * @brief  按堆顶的到期时间设置timerfd，堆为空时停止timerfd
+          */
+        void arm();
+
+        // 驱动定时器的timerfd
+        int timer_fd_ = -1;
+        // 按到期时间排列的定时器小根堆
+        std::vector<std::shared_ptr<Timer>> heap_;
+        // timerfd当前设置的到期时间，0表示未设置
+        int64_t armed_when_ = 0;
+        // 堆达到该大小时移除已取消的定时器
+        size_t compact_at_ = kMinCompact;
+
+    };
+
+}
@@ -0,0 +1,98 @@
+#include "TimingWheel.h"
+
+using namespace std;
+using namespace CwNetWork;
+
+TimingWheel::TimingWheel(uint64_t now) : current_(now) {
+    for (auto &head: slots_) {
+        head.prev = &head;
+        head.next = &head;
+    }
+}
+
+void TimingWheel::add(TimerNode *node, uint64_t expire) {
+    remove(node);
+    node->expire = expire;
+    place(node, expire > current_ ? expire : current_ + 1);
+    ++size_;
+}
+
+void TimingWheel::remove(TimerNode *node) {
+    if (!node->linked()) {
+        return;
+    }
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = nullptr;
+    node->next = nullptr;
+    --size_;
+}
+
+void TimingWheel::advance(uint64_t target, const ExpireCallBack &callback) {
+    TimerNode expired;
+    while (current_ < target) {
+        ++current_;
+        uint64_t index = current_ & (kRootSize - 1);
+        if (index == 0) {
+            for (int level = 1; level < kLevels && cascade(level); ++level) {}
+        }
+        TimerNode *head = slot(0, index);
+        if (head->next == head) {
+            continue;
+        }
+        // 先整体摘下到期链表，回调中对时间轮的修改不会影响本次遍历
+        expired.next = head->next;
+        expired.prev = head->prev;
+        expired.next->prev = &expired;
+        expired.prev->next = &expired;
+        head->prev = head;
+        head->next = head;
+        while (expired.next != &expired) {
+            TimerNode *node = expired.next;
+            remove(node);
+            callback(node);
+        }
+    }
+}
+
+void TimingWheel::place(TimerNode *node, uint64_t expire) {
+    uint64_t delta = expire - current_;
+    if (delta < kRootSize) {
+        link(slot(0, expire & (kRootSize - 1)), node);
+        return;
+    }
+    for (int level = 1; level < kLevels; ++level) {
+        int shift = kRootBits + level * kLevelBits;
+        if (delta < (1ULL << shift) || level == kLevels - 1) {
+            if (delta >= (1ULL << shift)) {
+                expire = current_ + (1ULL << shift) - 1;
+            }
+            link(slot(level, (expire >> (shift - kLevelBits)) & (kLevelSize - 1)), node);
+            return;
+        }
+    }
+}
+
+bool TimingWheel::cascade(int level) {
+    uint64_t index = (current_ >> (kRootBits + (level - 1) * kLevelBits)) & (kLevelSize - 1);
+    TimerNode *head = slot(level, index);
+    while (head->next != head) {
+        TimerNode *node = head->next;
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        // 下放发生在处理当前刻度的槽位之前，恰好在当前刻度到期的节点仍能按时触发
+        place(node, node->expire > current_ ? node->expire : current_);
+    }
+    return index == 0;
+}
+
+TimerNode *TimingWheel::slot(int level, uint64_t index) {
+    return level == 0 ? &slots_[index] : &slots_[kRootSize + (level - 1) * kLevelSize + index];
+}
+
+void TimingWheel::link(TimerNode *head, TimerNode *node) {
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
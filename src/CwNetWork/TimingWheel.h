@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+namespace CwNetWork {
+
+    /*
+     * 侵入式定时器节点，嵌入在需要定时的对象中，插入和删除均为O(1)且不分配内存
+     */
+    struct TimerNode {
+        // 所在槽位链表的前驱
+        TimerNode *prev = nullptr;
+        // 所在槽位链表的后继
+        TimerNode *next = nullptr;
+        // 到期的刻度
+        uint64_t expire = 0;
+        // 节点所属的对象
+        void *owner = nullptr;
+
+        /**
+          * @brief  判断节点是否在时间轮中
+          * @retval 是否在时间轮中
+          */
+        bool linked() const { return next != nullptr; }
+    };
+
+    /*
+     * 分层哈希时间轮，第0层256个槽位，其余3层各64个槽位，刻度的时间长度由使用者决定
+     * 每推进一个刻度只处理到期的槽位，高层槽位在低层转满一圈时逐级下放
+     */
+    class TimingWheel {
+
+    public:
+
+        // 节点到期时执行的回调函数，回调中可以重新加入或删除任意节点
+        using ExpireCallBack = std::function<void(TimerNode *)>;
+
+        /**
+          * @brief  构造一个时间轮
+          * @param  当前刻度
+          */
+        explicit TimingWheel(uint64_t now = 0);
+
+        TimingWheel(const TimingWheel &) = delete;
+
+        TimingWheel &operator=(const TimingWheel &) = delete;
+
+        /**
+          * @brief  将节点加入时间轮，节点已在时间轮中时先将其删除
+          * @note   到期刻度不晚于当前刻度的节点将在下一次推进时到期
+          * @param  _1:定时器节点 _2:到期的刻度
+          */
+        void add(TimerNode *, uint64_t);
+
+        /**
+          * @brief  将节点从时间轮中删除，节点不在时间轮中时什么也不做
+          * @param  定时器节点
+          */
+        void remove(TimerNode *);
+
+        /**
+          * @brief  将时间轮推进到指定刻度，并依次对到期的节点执行回调
+          * @param  _1:目标刻度 _2:节点到期时执行的回调函数
+          */
+        void advance(uint64_t, const ExpireCallBack &);
+
+        /**
+          * @brief  获取当前刻度
+          * @retval 当前刻度
+          */
+        uint64_t now() const { return current_; }
+
+        /**
+          * @brief  获取时间轮中的节点数
+          * @retval 节点数
+          */
+        size_t size() const { return size_; }
+
+    private:
+
+        static const int kLevels = 4;
+        static const int kRootBits = 8;
+        static const int kLevelBits = 6;
+        static const uint64_t kRootSize = 1 << kRootBits;
+        static const uint64_t kLevelSize = 1 << kLevelBits;
+
+        /**
+          * @brief  根据到期刻度将节点挂到对应的槽位
+          * @param  _1:定时器节点 _2:用于放置的到期刻度，不早于当前刻度
+          */
+        void place(TimerNode *, uint64_t);
+
+        /**
+          * @brief  将第level层下一个槽位的节点重新放置到更低的层
+          * @param  层号
+          * @retval 该层是否也转满了一圈
+          */
+        bool cascade(int);
+
+        /**
+          * @brief  获取指定层指定下标的槽位哨兵
+          * @param  _1:层号 _2:槽位下标
+          * @retval 槽位哨兵节点
+          */
+        TimerNode *slot(int, uint64_t);
+
+        /**
+          * @brief  将节点链接到哨兵之前(即链表末尾)
+          * @param  _1:哨兵节点 _2:定时器节点
+          */
+        static void link(TimerNode *, TimerNode *);
+
+        // 全部槽位的哨兵节点，第0层在前
+        TimerNode slots_[kRootSize + (kLevels - 1) * kLevelSize];
+        // 当前刻度
+        uint64_t current_;
+        // 时间轮中的节点数
+        size_t size_ = 0;
+
+    };
+
+}
@@ -0,0 +1,259 @@
+#include "UdpServer.h"
+#include "TcpServer.h"
+#include "Poller.h"
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <thread>
+
+using namespace std;
+using namespace CwNetWork;
+
+// 每次可读事件最多连续recvmmsg的批数，避免一个繁忙的套接字让唤醒事件得不到处理
+static const int kReceiveRounds = 16;
+
+// 当前线程所在的Worker，不在UdpServer的线程中时为nullptr
+static thread_local void *t_worker = nullptr;
+
+struct UdpServer::Worker {
+    // 该线程的服务端套接字
+    unique_ptr<ServerSocket> socket;
+    // 该线程的IO多路复用模型
+    unique_ptr<Poller> poller;
+    // 跨线程唤醒的eventfd
+    int wakeup_fd = -1;
+    // recvmmsg的消息头、数据区描述和对端地址
+    vector<struct mmsghdr> msgs;
+    vector<struct iovec> iovs;
+    vector<struct sockaddr_storage> names;
+    // 接收缓冲区，每个数据报占max_size_字节
+    vector<char> buffer;
+    // 本批缓存的回复
+    vector<pair<AddrInfo, string>> replies;
+    // 本批缓存的会话刷新
+    vector<uint64_t> touched;
+    // 所属的Udp服务端
+    const UdpServer *owner = nullptr;
+
+    ~Worker() {
+        if (socket != nullptr) {
+            socket->closeFd();
+        }
+        if (wakeup_fd != -1) {
+            close(wakeup_fd);
+        }
+    }
+};
+
+const size_t UdpServer::kMaxBatchSize;
+
+UdpServer::UdpServer(const AddrInfo &addr, TcpServer *tcp_server) : addr_(addr), tcp_server_(tcp_server) {}
+
+UdpServer::~UdpServer() = default;
+
+void UdpServer::setBatchSize(size_t batch_size) {
+    batch_size_ = batch_size == 0 ? 1 : batch_size > kMaxBatchSize ? kMaxBatchSize : batch_size;
+}
+
+bool UdpServer::run() {
+    if (!initServer()) {
+        workers_.clear();
+        return false;
+    }
+    running_.store(true);
+    vector<thread> threads;
+    for (size_t i = 1; i < workers_.size(); ++i) {
+        threads.emplace_back([this, i]() { loop(*workers_[i]); });
+    }
+    loop(*workers_[0]);
+    for (auto &t: threads) {
+        t.join();
+    }
+    running_.store(false);
+    quit_.store(false);
+    return true;
+}
+
+void UdpServer::stop() {
+    // 先置位退出标志，run尚未开始循环时也会立即返回
+    quit_.store(true);
+    if (!running_.load()) {
+        return;
+    }
+    uint64_t one = 1;
+    for (auto &worker: workers_) {
+        write(worker->wakeup_fd, &one, sizeof(one));
+    }
+}
+
+bool UdpServer::sendTo(const AddrInfo &addr, const string &data) {
+    Worker *worker = currentWorker();
+    if (worker != nullptr) {
+        worker->replies.emplace_back(addr, data);
+        return true;
+    }
+    if (!running_.load(memory_order_acquire)) {
+        return false;
+    }
+    ssize_t slen = sendto(workers_[0]->socket->getFd(), data.data(), data.size(), MSG_NOSIGNAL,
+                          addr.getSockAddrPtr(), addr.getSockLen());
+    return slen == static_cast<ssize_t>(data.size());
+}
+
+bool UdpServer::touch(uint64_t session) {
+    if (tcp_server_ == nullptr) {
+        return false;
+    }
+    Worker *worker = currentWorker();
+    if (worker == nullptr) {
+        return tcp_server_->touchSessions({session}) > 0;
+    }
+    if (!tcp_server_->isSessionAlive(session)) {
+        return false;
+    }
+    worker->touched.push_back(session);
+    return true;
+}
+
+bool UdpServer::initServer() {
+    error_.clear();
+    if (message_cb_ == nullptr) {
+        error_ = "the callback function for receiving datagrams is not set";
+        return false;
+    }
+    if (addr_.getFamily() != AF_INET && addr_.getFamily() != AF_INET6) {
+        error_ = "the listen address is invalid";
+        return false;
+    }
+    workers_.clear();
+    for (size_t i = 0; i < loop_num_; ++i) {
+        unique_ptr<Worker> worker(new Worker);
+        worker->owner = this;
+        worker->socket.reset(new ServerSocket(ServerSocket::newServerSocket(addr_.getFamily(), SOCK_DGRAM)));
+        if (worker->socket->getFd() == -1) {
+            error_ = "failed to create the udp socket";
+            return false;
+        }
+        if (loop_num_ > 1 && !worker->socket->setReusePort()) {
+            error_ = "the SO_REUSEPORT setting failed";
+            return false;
+        }
+        string option;
+        if (!socket_options_.applyTo(*worker->socket, option)) {
+            error_ = "failed to set the socket option " + option;
+            return false;
+        }
+        if (!worker->socket->serverBind(addr_)) {
+            error_ = "failed to bind " + addr_.toString();
+            return false;
+        }
+        worker->socket->setNonBlock();
+        worker->poller = Poller::newPoller(IoBackend::EPOLL_LT);
+        worker->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (worker->poller == nullptr || worker->wakeup_fd == -1 ||
+            !worker->poller->add(worker->socket->getFd(), EPOLLIN, worker->socket.get()) ||
+            !worker->poller->add(worker->wakeup_fd, EPOLLIN, &worker->wakeup_fd)) {
+            error_ = "failed to create the poller";
+            return false;
+        }
+        worker->msgs.resize(batch_size_);
+        worker->iovs.resize(batch_size_);
+        worker->names.resize(batch_size_);
+        worker->buffer.resize(batch_size_ * max_size_);
+        for (size_t j = 0; j < batch_size_; ++j) {
+            worker->iovs[j].iov_base = worker->buffer.data() + j * max_size_;
+            worker->iovs[j].iov_len = max_size_;
+            struct msghdr &hdr = worker->msgs[j].msg_hdr;
+            hdr.msg_name = &worker->names[j];
+            hdr.msg_iov = &worker->iovs[j];
+            hdr.msg_iovlen = 1;
+        }
+        workers_.push_back(std::move(worker));
+    }
+    return true;
+}
+
+void UdpServer::loop(Worker &worker) {
+    t_worker = &worker;
+    while (!quit_.load()) {
+        int ev_num = worker.poller->wait(-1);
+        if (ev_num == -1 && errno != EINTR) {
+            break;
+        }
+        for (int i = 0; i < ev_num; ++i) {
+            if ((*worker.poller)[i].data.ptr == &worker.wakeup_fd) {
+                uint64_t count = 0;
+                read(worker.wakeup_fd, &count, sizeof(count));
+            } else {
+                receive(worker);
+            }
+        }
+    }
+    t_worker = nullptr;
+}
+
+void UdpServer::receive(Worker &worker) {
+    for (int round = 0; round < kReceiveRounds; ++round) {
+        for (size_t i = 0; i < batch_size_; ++i) {
+            worker.msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+            worker.msgs[i].msg_hdr.msg_flags = 0;
+        }
+        int count = recvmmsg(worker.socket->getFd(), worker.msgs.data(), static_cast<unsigned int>(batch_size_),
+                             MSG_DONTWAIT, nullptr);
+        if (count <= 0) {
+            break;
+        }
+        for (int i = 0; i < count; ++i) {
+            const struct msghdr &hdr = worker.msgs[i].msg_hdr;
+            if (hdr.msg_flags & MSG_TRUNC) {
+                continue;
+            }
+            AddrInfo peer(static_cast<const struct sockaddr *>(hdr.msg_name), hdr.msg_namelen);
+            message_cb_(peer, static_cast<const char *>(worker.iovs[i].iov_base), worker.msgs[i].msg_len, this);
+        }
+        flush(worker);
+        if (static_cast<size_t>(count) < batch_size_) {
+            break;
+        }
+    }
+}
+
+void UdpServer::flush(Worker &worker) {
+    if (!worker.touched.empty()) {
+        tcp_server_->touchSessions(worker.touched);
+        worker.touched.clear();
+    }
+    size_t sent = 0;
+    vector<struct mmsghdr> msgs;
+    vector<struct iovec> iovs;
+    while (sent < worker.replies.size()) {
+        size_t count = min(worker.replies.size() - sent, batch_size_);
+        msgs.assign(count, mmsghdr());
+        iovs.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            auto &reply = worker.replies[sent + i];
+            iovs[i].iov_base = const_cast<char *>(reply.second.data());
+            iovs[i].iov_len = reply.second.size();
+            msgs[i].msg_hdr.msg_name = reply.first.getSockAddrPtr();
+            msgs[i].msg_hdr.msg_namelen = reply.first.getSockLen();
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+        int done = sendmmsg(worker.socket->getFd(), msgs.data(), static_cast<unsigned int>(count), MSG_NOSIGNAL);
+        if (done == -1 && errno == EINTR) {
+            continue;
+        }
+        if (done <= 0) {
+            // 发送缓冲区已满或对端不可达，Udp不重传，丢弃剩余的回复
+            break;
+        }
+        sent += done;
+    }
+    worker.replies.clear();
+}
+
+UdpServer::Worker *UdpServer::currentWorker() const {
+    auto worker = static_cast<Worker *>(t_worker);
+    return worker != nullptr && worker->owner == this ? worker : nullptr;
+}
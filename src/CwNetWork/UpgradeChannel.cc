@@ -0,0 +1,388 @@
+#include "UpgradeChannel.h"
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+using namespace std;
+using namespace CwNetWork;
+
+// 每帧附带的最大描述符数，内核限制为SCM_MAX_FD(253)
+static const size_t kMaxFdsPerFrame = 250;
+
+// 帧头魔数，用于识别版本不兼容的对端
+static const uint32_t kFrameMagic = 0x43575550;
+
+// 单帧负载的上限，超过时认为数据损坏
+static const uint64_t kMaxPayload = 1ULL << 32;
+
+// 发送结束帧后等待接收方确认的毫秒数
+static const int kAckTimeoutMs = 5000;
+
+// 接收方完整接收后回复的确认字节
+static const char kAck = 'K';
+
+// 帧类型
+enum FrameType : uint32_t {
+    LISTENERS = 1, CONNECTIONS = 2, END = 3
+};
+
+// 待发送段的类型
+enum SegmentKind : uint8_t {
+    MEMORY = 0, FILE_RANGE = 1, PIPE = 2
+};
+
+struct FrameHeader {
+    uint32_t magic;
+    uint32_t type;
+    uint32_t fd_count;
+    uint32_t records;
+    uint64_t payload_len;
+};
+
+static void putU32(string &out, uint32_t value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void putU64(string &out, uint64_t value) {
+    out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static void putBytes(string &out, const char *data, size_t len) {
+    putU64(out, len);
+    out.append(data, len);
+}
+
+/*
+ * 按写入顺序读取负载中的字段，越界时置为失败并返回零值
+ */
+class PayloadReader {
+
+public:
+
+    explicit PayloadReader(const string &payload) : data_(payload.data()), end_(payload.data() + payload.size()) {}
+
+    bool ok() const { return ok_; }
+
+    template<typename T>
+    T get() {
+        T value{};
+        if (!ok_ || static_cast<size_t>(end_ - data_) < sizeof(T)) {
+            ok_ = false;
+            return value;
+        }
+        memcpy(&value, data_, sizeof(T));
+        data_ += sizeof(T);
+        return value;
+    }
+
+    string bytes() {
+        auto len = get<uint64_t>();
+        if (!ok_ || static_cast<uint64_t>(end_ - data_) < len) {
+            ok_ = false;
+            return {};
+        }
+        string value(data_, len);
+        data_ += len;
+        return value;
+    }
+
+private:
+
+    const char *data_;
+    const char *end_;
+    bool ok_ = true;
+
+};
+
+static void closeAll(const vector<int> &fds) {
+    for (int fd: fds) {
+        close(fd);
+    }
+}
+
+static bool writeAll(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t wlen = write(fd, data, len);
+        if (wlen == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += wlen;
+        len -= wlen;
+    }
+    return true;
+}
+
+static bool readAll(int fd, char *data, size_t len) {
+    while (len > 0) {
+        ssize_t rlen = read(fd, data, len);
+        if (rlen == -1 && errno == EINTR) {
+            continue;
+        }
+        if (rlen <= 0) {
+            return false;
+        }
+        data += rlen;
+        len -= rlen;
+    }
+    return true;
+}
+
+static bool fillAddress(const string &path, struct sockaddr_un &addr) {
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+/**
+  * @brief  解析一帧中的连接记录并追加到连接集合
+  * @param  _1:记录数 _2:负载 _3:该帧附带的描述符 _4:连接集合
+  * @retval 负载是否完整有效
+  */
+static bool parseConnections(uint32_t records, const string &payload, const vector<int> &fds,
+                             vector<HandoffConnection> &conns) {
+    PayloadReader reader(payload);
+    auto fdAt = [&reader, &fds]() {
+        auto index = reader.get<uint32_t>();
+        return reader.ok() && index < fds.size() ? fds[index] : -1;
+    };
+    for (uint32_t i = 0; i < records; ++i) {
+        HandoffConnection conn;
+        conn.fd = fdAt();
+        string addr = reader.bytes();
+        if (conn.fd == -1 || addr.size() > AddrInfo::kMaxSockLen) {
+            return false;
+        }
+        struct sockaddr_storage sockaddr{};
+        memcpy(&sockaddr, addr.data(), addr.size());
+        conn.addr_info = AddrInfo(reinterpret_cast<struct sockaddr *>(&sockaddr), static_cast<socklen_t>(addr.size()));
+        conn.input = reader.bytes();
+        conn.state = reader.bytes();
+        auto segments = reader.get<uint32_t>();
+        for (uint32_t j = 0; j < segments && reader.ok(); ++j) {
+            HandoffSegment segment;
+            auto kind = reader.get<uint8_t>();
+            if (kind == MEMORY) {
+                segment.data = reader.bytes();
+            } else {
+                segment.fd = fdAt();
+                segment.pipe = kind == PIPE;
+                segment.offset = static_cast<off_t>(reader.get<uint64_t>());
+                segment.len = reader.get<uint64_t>();
+                if (segment.fd == -1) {
+                    return false;
+                }
+            }
+            conn.output.push_back(std::move(segment));
+        }
+        if (!reader.ok()) {
+            return false;
+        }
+        conns.push_back(std::move(conn));
+    }
+    return true;
+}
+
+UpgradeChannel::~UpgradeChannel() {
+    if (fd_ != -1) {
+        close(fd_);
+    }
+}
+
+int UpgradeChannel::listen(const string &path) {
+    struct sockaddr_un addr{};
+    if (!fillAddress(path, addr)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    unlink(path.c_str());
+    if (bind(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == -1 || ::listen(fd, 1) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int UpgradeChannel::connect(const string &path) {
+    struct sockaddr_un addr{};
+    if (!fillAddress(path, addr)) {
+        return -1;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == -1) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool UpgradeChannel::sendListeners(const vector<int> &fds) {
+    for (size_t i = 0; i < fds.size(); i += kMaxFdsPerFrame) {
+        vector<int> batch(fds.begin() + i, fds.begin() + min(fds.size(), i + kMaxFdsPerFrame));
+        if (!sendFrame(LISTENERS, static_cast<uint32_t>(batch.size()), string(), batch)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool UpgradeChannel::sendConnections(const vector<HandoffConnection> &conns) {
+    string payload;
+    vector<int> fds;
+    uint32_t records = 0;
+    for (auto &conn: conns) {
+        size_t need = 1;
+        for (auto &segment: conn.output) {
+            need += segment.fd != -1 ? 1 : 0;
+        }
+        if (need > kMaxFdsPerFrame) {
+            return false;
+        }
+        if (fds.size() + need > kMaxFdsPerFrame) {
+            if (!sendFrame(CONNECTIONS, records, payload, fds)) {
+                return false;
+            }
+            payload.clear();
+            fds.clear();
+            records = 0;
+        }
+        putU32(payload, static_cast<uint32_t>(fds.size()));
+        fds.push_back(conn.fd);
+        putBytes(payload, reinterpret_cast<const char *>(conn.addr_info.getSockAddrPtr()), conn.addr_info.getSockLen());
+        putBytes(payload, conn.input.data(), conn.input.size());
+        putBytes(payload, conn.state.data(), conn.state.size());
+        putU32(payload, static_cast<uint32_t>(conn.output.size()));
+        for (auto &segment: conn.output) {
+            if (segment.fd == -1) {
+                payload.push_back(static_cast<char>(MEMORY));
+                putBytes(payload, segment.data.data(), segment.data.size());
+                continue;
+            }
+            payload.push_back(static_cast<char>(segment.pipe ? PIPE : FILE_RANGE));
+            putU32(payload, static_cast<uint32_t>(fds.size()));
+            fds.push_back(segment.fd);
+            putU64(payload, static_cast<uint64_t>(segment.offset));
+            putU64(payload, segment.len);
+        }
+        ++records;
+    }
+    return records == 0 || sendFrame(CONNECTIONS, records, payload, fds);
+}
+
+bool UpgradeChannel::finish() {
+    if (!sendFrame(END, 0, string(), vector<int>())) {
+        return false;
+    }
+    struct timeval timeout{kAckTimeoutMs / 1000, (kAckTimeoutMs % 1000) * 1000};
+    setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char ack = 0;
+    return readAll(fd_, &ack, 1) && ack == kAck;
+}
+
+bool UpgradeChannel::receive(vector<int> &listen_fds, vector<HandoffConnection> &conns) {
+    listen_fds.clear();
+    conns.clear();
+    // 已收到的全部描述符，失败时统一关闭
+    vector<int> received;
+    bool done = false;
+    while (!done) {
+        uint32_t type = 0, records = 0;
+        string payload;
+        vector<int> fds;
+        bool ok = recvFrame(type, records, payload, fds);
+        received.insert(received.end(), fds.begin(), fds.end());
+        if (!ok) {
+            break;
+        }
+        if (type == END) {
+            done = true;
+        } else if (type == LISTENERS && records == fds.size()) {
+            listen_fds.insert(listen_fds.end(), fds.begin(), fds.end());
+        } else if (type != CONNECTIONS || !parseConnections(records, payload, fds, conns)) {
+            break;
+        }
+    }
+    if (done && !writeAll(fd_, &kAck, 1)) {
+        done = false;
+    }
+    if (!done) {
+        closeAll(received);
+        listen_fds.clear();
+        conns.clear();
+    }
+    return done;
+}
+
+bool UpgradeChannel::sendFrame(uint32_t type, uint32_t records, const string &payload, const vector<int> &fds) {
+    FrameHeader header{kFrameMagic, type, static_cast<uint32_t>(fds.size()), records, payload.size()};
+    struct iovec iov{&header, sizeof(header)};
+    struct msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    char control[CMSG_SPACE(kMaxFdsPerFrame * sizeof(int))];
+    if (!fds.empty()) {
+        size_t fds_len = fds.size() * sizeof(int);
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(fds_len);
+        struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(fds_len);
+        memcpy(CMSG_DATA(cm), fds.data(), fds_len);
+    }
+    ssize_t slen;
+    do {
+        slen = sendmsg(fd_, &msg, MSG_NOSIGNAL);
+    } while (slen == -1 && errno == EINTR);
+    if (slen == -1) {
+        return false;
+    }
+    // 帧头极短，描述符只随第一个字节发送，剩余部分按普通数据写完
+    return writeAll(fd_, reinterpret_cast<const char *>(&header) + slen, sizeof(header) - slen) &&
+           writeAll(fd_, payload.data(), payload.size());
+}
+
+bool UpgradeChannel::recvFrame(uint32_t &type, uint32_t &records, string &payload, vector<int> &fds) {
+    FrameHeader header{};
+    struct iovec iov{&header, sizeof(header)};
+    struct msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    char control[CMSG_SPACE(kMaxFdsPerFrame * sizeof(int))];
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    ssize_t rlen;
+    do {
+        rlen = recvmsg(fd_, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+    } while (rlen == -1 && errno == EINTR);
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); rlen > 0 && cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level == SOL_SOCKET && cm->cmsg_type == SCM_RIGHTS) {
+            size_t count = (cm->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            size_t offset = fds.size();
+            fds.resize(offset + count);
+            memcpy(fds.data() + offset, CMSG_DATA(cm), count * sizeof(int));
+        }
+    }
+    if (rlen != sizeof(header) || (msg.msg_flags & MSG_CTRUNC) || header.magic != kFrameMagic ||
+        header.fd_count != fds.size() || header.payload_len > kMaxPayload) {
+        return false;
+    }
+    type = header.type;
+    records = header.records;
+    payload.resize(header.payload_len);
+    return readAll(fd_, &payload[0], payload.size());
+}
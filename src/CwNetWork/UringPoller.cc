@@ -0,0 +1,643 @@
+#include "UringPoller.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+using namespace std;
+using namespace CwNetWork;
+
+// 无需处理的完成事件(撤销请求、提供缓冲区)的用户数据
+static const uint64_t kIgnoreUserData = ~0ULL;
+// 检测多次触发的recv请求时使用的用户数据
+static const uint64_t kProbeUserData = ~1ULL;
+// 用户数据的高32位为文件描述符，低32位的最高3位为请求类型，其余为序号
+static const unsigned kKindShift = 29;
+static const uint32_t kTagMask = (1u << kKindShift) - 1;
+// 多次触发请求和发送请求的序号由注册代数和请求序号组成，请求序号占低13位
+static const unsigned kSeqBits = 13;
+static const uint32_t kSeqMask = (1u << kSeqBits) - 1;
+// 请求类型
+static const uint32_t kPollKind = 0;
+static const uint32_t kRecvKind = 1;
+static const uint32_t kAcceptKind = 2;
+static const uint32_t kSendKind = 3;
+// 接收缓冲区的个数和大小，交付后在下一次wait时归还
+static const unsigned kBufferCount = 128;
+static const size_t kBufferSize = 16384;
+static const uint16_t kBufferGroup = 1;
+
+static inline uint64_t userData(int fd, uint32_t kind, uint32_t tag) {
+    return (static_cast<uint64_t>(fd) << 32) | (kind << kKindShift) | (tag & kTagMask);
+}
+
+static inline uint32_t tagOf(uint16_t gen, uint32_t seq) {
+    return (static_cast<uint32_t>(gen) << kSeqBits) | (seq & kSeqMask);
+}
+
+UringPoller::UringPoller(int init_size) : Poller(init_size) {
+    struct io_uring_params params{};
+    unsigned entries = 256;
+    params.flags = IORING_SETUP_SUBMIT_ALL;
+    ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd_ == -1 && errno == EINVAL) {
+        params = io_uring_params{};
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+    if (ring_fd_ == -1) {
+        return;
+    }
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_ring_size_ = cq_ring_size_ = max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                   IORING_OFF_SQ_RING);
+    cq_ptr_ = single_mmap ? sq_ptr_ : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                           ring_fd_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQES);
+    if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes == MAP_FAILED) {
+        release();
+        return;
+    }
+    sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+    auto sq = static_cast<char *>(sq_ptr_);
+    auto cq = static_cast<char *>(cq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    auto sq_array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < sq_entries_; ++i) {
+        sq_array[i] = i;
+    }
+    sq_local_tail_ = *sq_tail_;
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+    // wait依赖IORING_ENTER_EXT_ARG带超时等待，不支持时每次wait都会失败，事件循环将空转
+    if (!(params.features & IORING_FEAT_EXT_ARG)) {
+        release();
+        return;
+    }
+    results_.resize(events_.size());
+    completions_ = setupCompletions();
+}
+
+UringPoller::~UringPoller() {
+    release();
+}
+
+bool UringPoller::setupCompletions() {
+    void *buffers = mmap(nullptr, kBufferCount * kBufferSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                         -1, 0);
+    if (buffers == MAP_FAILED) {
+        return false;
+    }
+    buffers_ = static_cast<char *>(buffers);
+    int sv[2];
+    if (!provideBuffers(0, kBufferCount)
+        || socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, sv) == -1) {
+        return false;
+    }
+    // 先写入数据再提交，支持时recv请求立即完成并带有IORING_CQE_F_MORE；关闭对端后请求以0结束
+    struct io_uring_sqe *sqe = getSqe();
+    bool supported = false;
+    if (sqe != nullptr && ::write(sv[1], "", 1) == 1) {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = sv[0];
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        sqe->user_data = kProbeUserData;
+        vector<Cqe> cqes;
+        bool first = true;
+        bool more = true;
+        for (int round = 0; more && round < 8 && enter(1, 1000) != -1; ++round) {
+            reap(cqes);
+            for (const Cqe &cqe : cqes) {
+                if (cqe.flags & IORING_CQE_F_BUFFER) {
+                    used_buffers_.push_back(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+                }
+                if (cqe.user_data != kProbeUserData) {
+                    continue;
+                }
+                more = cqe.flags & IORING_CQE_F_MORE;
+                if (first && more) {
+                    supported = cqe.res == 1;
+                    close(sv[1]);
+                    sv[1] = -1;
+                }
+                first = false;
+            }
+            cqes.clear();
+        }
+    }
+    close(sv[0]);
+    if (sv[1] != -1) {
+        close(sv[1]);
+    }
+    return supported;
+}
+
+bool UringPoller::add(int fd, uint32_t events, void *ptr) {
+    if (fd < 0) {
+        return false;
+    }
+    if (static_cast<size_t>(fd) >= regs_.size()) {
+        regs_.resize(fd + 1);
+    }
+    Registration &reg = regs_[fd];
+    if (reg.active) {
+        return false;
+    }
+    reg.events = events;
+    reg.data.ptr = ptr;
+    reg.mode = Mode::POLL;
+    reg.active = true;
+    return arm(fd);
+}
+
+bool UringPoller::addListener(int fd, void *ptr) {
+    if (!completions_ || !add(fd, 0, ptr)) {
+        return false;
+    }
+    regs_[fd].mode = Mode::LISTENER;
+    return armMulti(fd);
+}
+
+bool UringPoller::addReceiver(int fd, uint32_t events, void *ptr) {
+    if (!completions_ || fd < 0) {
+        return false;
+    }
+    if (static_cast<size_t>(fd) >= regs_.size()) {
+        regs_.resize(fd + 1);
+    }
+    Registration &reg = regs_[fd];
+    if (reg.active) {
+        return false;
+    }
+    reg.events = events;
+    reg.data.ptr = ptr;
+    reg.mode = Mode::RECEIVER;
+    reg.active = true;
+    return arm(fd) && (!(events & EPOLLIN) || armMulti(fd));
+}
+
+bool UringPoller::mod(int fd, uint32_t events, void *ptr) {
+    if (fd < 0 || static_cast<size_t>(fd) >= regs_.size() || !regs_[fd].active) {
+        return false;
+    }
+    Registration &reg = regs_[fd];
+    reg.data.ptr = ptr;
+    if (reg.mode != Mode::RECEIVER) {
+        if (!disarm(fd)) {
+            return false;
+        }
+        reg.events = events;
+        return arm(fd);
+    }
+    // 监听请求只在EPOLLIN以外的事件变化时重新提交，EPOLLIN的变化提交或撤销recv请求
+    uint32_t changed = reg.events ^ events;
+    reg.events = events;
+    if ((changed & ~static_cast<uint32_t>(EPOLLIN)) && !(disarm(fd) && arm(fd))) {
+        return false;
+    }
+    if (!(changed & EPOLLIN) || (reg.multi_armed == static_cast<bool>(events & EPOLLIN))) {
+        return true;
+    }
+    return (events & EPOLLIN) ? armMulti(fd) : disarmMulti(fd);
+}
+
+bool UringPoller::del(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= regs_.size() || !regs_[fd].active) {
+        return false;
+    }
+    Registration &reg = regs_[fd];
+    bool ok = disarm(fd);
+    if (reg.multi_armed) {
+        ok = disarmMulti(fd) && ok;
+    }
+    if (reg.sending) {
+        ok = cancelSend(fd) && ok;
+    }
+    reg.active = false;
+    ++reg.gen;
+    return ok;
+}
+
+bool UringPoller::send(int fd, const struct iovec *iov, size_t iov_num, int flags) {
+    if (fd < 0 || static_cast<size_t>(fd) >= regs_.size() || iov_num == 0 || iov_num > kMaxSendIov) {
+        return false;
+    }
+    Registration &reg = regs_[fd];
+    if (!reg.active || reg.mode != Mode::RECEIVER || reg.sending) {
+        return false;
+    }
+    struct io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->fd = fd;
+    sqe->msg_flags = static_cast<uint32_t>(flags);
+    if (iov_num == 1) {
+        sqe->opcode = IORING_OP_SEND;
+        sqe->addr = reinterpret_cast<uint64_t>(iov->iov_base);
+        sqe->len = static_cast<uint32_t>(iov->iov_len);
+    } else {
+        if (send_ops_.empty()) {
+            send_ops_.emplace_back(new SendOp);
+        }
+        reg.send_op = send_ops_.back().release();
+        send_ops_.pop_back();
+        memcpy(reg.send_op->iov, iov, iov_num * sizeof(struct iovec));
+        memset(&reg.send_op->msg, 0, sizeof(reg.send_op->msg));
+        reg.send_op->msg.msg_iov = reg.send_op->iov;
+        reg.send_op->msg.msg_iovlen = iov_num;
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = reinterpret_cast<uint64_t>(&reg.send_op->msg);
+        sqe->len = 1;
+    }
+    ++reg.send_seq;
+    reg.sending = true;
+    sqe->user_data = userData(fd, kSendKind, tagOf(reg.gen, reg.send_seq));
+    return true;
+}
+
+void UringPoller::settle(int fd, vector<Result> &results) {
+    if (fd < 0 || static_cast<size_t>(fd) >= regs_.size() || !regs_[fd].active) {
+        return;
+    }
+    Registration &reg = regs_[fd];
+    // 等待期间该注册保持有效，已完成的部分按当前注册交付到results，但不再重新提交任何请求
+    reg.settling = true;
+    disarm(fd);
+    if (reg.multi_armed) {
+        disarmMulti(fd);
+    }
+    if (reg.sending) {
+        cancelSend(fd);
+    }
+    Result result;
+    uint32_t events = 0;
+    auto collect = [&](vector<Cqe> &cqes, size_t from) {
+        size_t kept = from;
+        for (size_t i = from; i < cqes.size(); ++i) {
+            if (static_cast<int>(cqes[i].user_data >> 32) != fd || cqes[i].user_data == kIgnoreUserData) {
+                cqes[kept++] = cqes[i];
+            } else if (complete(cqes[i], result, events) == fd && result.type != Completion::READY) {
+                results.push_back(result);
+            }
+        }
+        cqes.resize(kept);
+    };
+    collect(backlog_, 0);
+    while (reg.multi_live > 0 || reg.sending) {
+        if (enter(1, -1) == -1 && errno != EINTR) {
+            break;
+        }
+        size_t from = backlog_.size();
+        reap(backlog_);
+        collect(backlog_, from);
+    }
+    reg.settling = false;
+    reg.active = false;
+    ++reg.gen;
+}
+
+int UringPoller::wait(int timeout) {
+    recycle();
+    // 先提交再收割，上一轮交付后重新提交的单次监听请求在事件处理完毕后才进入内核
+    bool ready = !backlog_.empty() || *cq_head_ != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if ((to_submit_ > 0 || !ready) && enter(ready ? 0 : 1, ready ? 0 : timeout) == -1
+        && errno != ETIME && errno != EINTR && !ready) {
+        return -1;
+    }
+    return harvest();
+}
+
+void UringPoller::release() {
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+        munmap(cq_ptr_, cq_ring_size_);
+    }
+    if (sq_ptr_ != nullptr && sq_ptr_ != MAP_FAILED) {
+        munmap(sq_ptr_, sq_ring_size_);
+    }
+    if (ring_fd_ != -1) {
+        close(ring_fd_);
+    }
+    // 关闭io_uring后内核不再引用接收缓冲区和发送请求的消息头
+    if (buffers_ != nullptr) {
+        munmap(buffers_, kBufferCount * kBufferSize);
+    }
+    for (Registration &reg : regs_) {
+        delete reg.send_op;
+        reg.send_op = nullptr;
+    }
+    sqes_ = nullptr;
+    sq_ptr_ = cq_ptr_ = nullptr;
+    buffers_ = nullptr;
+    ring_fd_ = -1;
+    completions_ = false;
+}
+
+bool UringPoller::provideBuffers(unsigned start, unsigned count) {
+    struct io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = static_cast<int>(count);
+    sqe->addr = reinterpret_cast<uint64_t>(buffers_ + start * kBufferSize);
+    sqe->len = static_cast<uint32_t>(kBufferSize);
+    sqe->off = start;
+    sqe->buf_group = kBufferGroup;
+    sqe->user_data = kIgnoreUserData;
+    return true;
+}
+
+void UringPoller::recycle() {
+    if (!used_buffers_.empty()) {
+        // 编号连续的缓冲区合并为一个请求归还
+        sort(used_buffers_.begin(), used_buffers_.end());
+        size_t start = 0;
+        for (size_t i = 1; i <= used_buffers_.size(); ++i) {
+            if (i == used_buffers_.size() || used_buffers_[i] != used_buffers_[i - 1] + 1) {
+                provideBuffers(used_buffers_[start], static_cast<unsigned>(i - start));
+                start = i;
+            }
+        }
+        used_buffers_.clear();
+    }
+    for (int fd : rearm_) {
+        Registration &reg = regs_[fd];
+        if (reg.active && !reg.settling && !reg.multi_armed
+            && (reg.mode == Mode::LISTENER || (reg.events & EPOLLIN))) {
+            armMulti(fd);
+        }
+    }
+    rearm_.clear();
+}
+
+struct io_uring_sqe *UringPoller::getSqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ - head >= sq_entries_) {
+        enter(0, 0);
+        head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sq_local_tail_ - head >= sq_entries_) {
+            return nullptr;
+        }
+    }
+    struct io_uring_sqe *sqe = &sqes_[sq_local_tail_ & sq_mask_];
+    memset(sqe, 0, sizeof(*sqe));
+    ++sq_local_tail_;
+    ++to_submit_;
+    return sqe;
+}
+
+bool UringPoller::arm(int fd) {
+    Registration &reg = regs_[fd];
+    uint32_t mask = reg.events & ~static_cast<uint32_t>(EPOLLET);
+    if (reg.mode == Mode::RECEIVER) {
+        mask &= ~static_cast<uint32_t>(EPOLLIN);
+    } else if (reg.mode == Mode::LISTENER) {
+        mask = 0;
+    }
+    if (mask == 0) {
+        return true;
+    }
+    struct io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    ++reg.seq;
+    reg.polling = true;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = mask;
+    // 多次触发的监听请求每次唤醒产生一个完成事件，即边沿触发；水平触发使用单次请求，交付后重新提交
+    sqe->len = (reg.events & EPOLLET) ? IORING_POLL_ADD_MULTI : 0;
+    sqe->user_data = userData(fd, kPollKind, reg.seq);
+    return true;
+}
+
+bool UringPoller::disarm(int fd) {
+    Registration &reg = regs_[fd];
+    if (!reg.polling) {
+        return true;
+    }
+    struct io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = userData(fd, kPollKind, reg.seq);
+    sqe->user_data = kIgnoreUserData;
+    ++reg.seq;
+    reg.polling = false;
+    return true;
+}
+
+bool UringPoller::armMulti(int fd) {
+    struct io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    Registration &reg = regs_[fd];
+    ++reg.multi_seq;
+    ++reg.multi_live;
+    reg.multi_armed = true;
+    sqe->fd = fd;
+    if (reg.mode == Mode::LISTENER) {
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        sqe->user_data = userData(fd, kAcceptKind, tagOf(reg.gen, reg.multi_seq));
+    } else {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        sqe->user_data = userData(fd, kRecvKind, tagOf(reg.gen, reg.multi_seq));
+    }
+    return true;
+}
+
+bool UringPoller::disarmMulti(int fd) {
+    struct io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    Registration &reg = regs_[fd];
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = userData(fd, reg.mode == Mode::LISTENER ? kAcceptKind : kRecvKind, tagOf(reg.gen, reg.multi_seq));
+    sqe->user_data = kIgnoreUserData;
+    reg.multi_armed = false;
+    return true;
+}
+
+bool UringPoller::cancelSend(int fd) {
+    struct io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        return false;
+    }
+    Registration &reg = regs_[fd];
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = userData(fd, kSendKind, tagOf(reg.gen, reg.send_seq));
+    sqe->user_data = kIgnoreUserData;
+    return true;
+}
+
+int UringPoller::enter(unsigned min_complete, int timeout) {
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+    unsigned flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0;
+    struct __kernel_timespec ts{};
+    struct io_uring_getevents_arg arg{};
+    void *argp = nullptr;
+    size_t argsz = 0;
+    if (min_complete > 0 && timeout >= 0) {
+        ts.tv_sec = timeout / 1000;
+        ts.tv_nsec = (timeout % 1000) * 1000000LL;
+        arg.ts = reinterpret_cast<uint64_t>(&ts);
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argsz = sizeof(arg);
+    }
+    int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit_, min_complete, flags, argp, argsz));
+    if (ret >= 0) {
+        to_submit_ -= min(static_cast<unsigned>(ret), to_submit_);
+    } else if (errno == ETIME || errno == EINTR) {
+        to_submit_ = sq_local_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    }
+    return ret;
+}
+
+void UringPoller::reap(vector<Cqe> &cqes) {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+        const struct io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        cqes.push_back({cqe.user_data, cqe.res, cqe.flags});
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+}
+
+int UringPoller::complete(const Cqe &cqe, Result &result, uint32_t &events) {
+    if (cqe.flags & IORING_CQE_F_BUFFER) {
+        used_buffers_.push_back(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+    }
+    auto fd = static_cast<int>(cqe.user_data >> 32);
+    if (cqe.user_data == kIgnoreUserData || fd < 0 || static_cast<size_t>(fd) >= regs_.size()) {
+        return -1;
+    }
+    Registration &reg = regs_[fd];
+    uint32_t kind = static_cast<uint32_t>(cqe.user_data) >> kKindShift;
+    uint32_t tag = static_cast<uint32_t>(cqe.user_data) & kTagMask;
+    bool more = cqe.flags & IORING_CQE_F_MORE;
+    bool current = reg.active && (tag >> kSeqBits) == reg.gen;
+    result.data = nullptr;
+    result.res = cqe.res;
+    events = 0;
+    switch (kind) {
+        case kPollKind:
+            if (!reg.active || (reg.seq & kTagMask) != tag) {
+                return -1;
+            }
+            if (!more) {
+                // 单次请求已完成，或多次触发的监听请求被内核终止(如完成队列溢出)，重新提交
+                reg.polling = false;
+                if (!reg.settling) {
+                    arm(fd);
+                }
+            }
+            if (cqe.res == -ECANCELED) {
+                return -1;
+            }
+            result.type = Completion::READY;
+            events = cqe.res < 0 ? EPOLLERR : static_cast<uint32_t>(cqe.res);
+            return fd;
+        case kRecvKind:
+        case kAcceptKind:
+            if (!more) {
+                reg.multi_live -= reg.multi_live > 0 ? 1 : 0;
+                // 当前请求因缓冲区耗尽或完成队列溢出被终止时在下一次wait重新提交；对端关闭和出错时不再提交
+                if (current && (tag & kSeqMask) == (reg.multi_seq & kSeqMask) && reg.multi_armed) {
+                    reg.multi_armed = false;
+                    if (!reg.settling && cqe.res != -ECANCELED
+                        && (kind == kAcceptKind || cqe.res > 0 || cqe.res == -ENOBUFS)) {
+                        rearm_.push_back(fd);
+                    }
+                }
+            }
+            if (kind == kAcceptKind && cqe.res >= 0 && !current) {
+                // 已停止监听的服务端套接字上接受的连接无人接管
+                close(cqe.res);
+                return -1;
+            }
+            if (!current || cqe.res == -ECANCELED || cqe.res == -ENOBUFS) {
+                return -1;
+            }
+            if (kind == kAcceptKind) {
+                result.type = Completion::ACCEPT;
+            } else {
+                result.type = Completion::RECV;
+                if (cqe.res > 0) {
+                    result.data = buffers_ + (cqe.flags >> IORING_CQE_BUFFER_SHIFT) * kBufferSize;
+                }
+            }
+            return fd;
+        case kSendKind:
+            if (!reg.sending || (tag & kSeqMask) != (reg.send_seq & kSeqMask)) {
+                return -1;
+            }
+            reg.sending = false;
+            if (reg.send_op != nullptr) {
+                send_ops_.emplace_back(reg.send_op);
+                reg.send_op = nullptr;
+            }
+            if (!current || cqe.res == -ECANCELED) {
+                return -1;
+            }
+            result.type = Completion::SEND;
+            return fd;
+        default:
+            return -1;
+    }
+}
+
+int UringPoller::harvest() {
+    reap(backlog_);
+    int ev_num = 0;
+    Result result;
+    uint32_t events = 0;
+    for (const Cqe &cqe : backlog_) {
+        int fd = complete(cqe, result, events);
+        if (fd == -1) {
+            continue;
+        }
+        if (static_cast<size_t>(ev_num) == events_.size()) {
+            events_.resize(events_.size() * 2);
+            results_.resize(events_.size());
+        }
+        events_[ev_num].events = events;
+        events_[ev_num].data = regs_[fd].data;
+        results_[ev_num] = result;
+        ++ev_num;
+    }
+    backlog_.clear();
+    return ev_num;
+}
@@ -1,14 +1,16 @@
 ﻿#include <map>
+#include <csignal>
 #include <set>
 #include <fstream>
 #include <iostream>
 #include <thread>
+#include <cstring>
 #include "CwUtil/Log.h"
 #include "CwUtil/Json.h"
 #include "CwNetWork/TcpServer.h"
+#include "CwNetWork/UdpServer.h"
 #include "CwHttp/HttpRequest.h"
 #include "httplib.h"
-#include <mutex>
 
 
 using namespace std;
@@ -16,14 +18,22 @@ using namespace CwUtil;
 using namespace CwHttp;
 using namespace CwNetWork;
 
-std::mutex map_mutex;
+// 仅在服务端事件循环线程中访问
 map<int, pair<string, bool>> online_map;
-map<int, pair<string, bool>> online_map_sendall;
 
 Json glob_config;
 
 Json java_server_config;
 
+// 收到SIGTERM或SIGINT时排空的服务端
+TcpServer *glob_server = nullptr;
+
+// 接收Udp心跳的服务端，未配置udp-port时为空
+UdpServer *glob_udp_server = nullptr;
+
+// 排空期限，期间在线用户收到EOF后自行断开，超时后统一断开
+const int drain_timeout_ms = 5000;
+
 Json readConfigFile(const std::string &path) {
     std::ifstream in(path, std::ios::in | std::ios::binary);
     if (!in) {
@@ -113,10 +123,12 @@ void recv_cb(Socket client, const std::string &msg, TcpServer *const server) {
             throw runtime_error("不存在user_name字段");
         }
         string user_name = root["user_name"].asString();
-        map_mutex.lock();
         online_map.emplace(client.getFd(), make_pair(user_name, true));
-        map_mutex.unlock();
         LOG_INFO << "新的用户登陆：" << user_name << LOG_ENDL;
+        if (glob_udp_server != nullptr) {
+            // 客户端此后可以改用Udp心跳，以该会话标识证明身份
+            server->sendAll(client, "session " + to_string(server->getSessionId(client)));
+        }
     } catch (const exception &e) {
         server->disConnect(client);
         LOG_ERROR << e.what() << LOG_ENDL;
@@ -142,9 +154,7 @@ void close_cb(const Socket &client, TcpServer *const server) {
         root["username"] = str_name;
         sendHttp(root.toString());  // { "username" : "xiongzp2" }
 
-        map_mutex.lock();
         online_map.erase(client.getFd());
-        map_mutex.unlock();
     } catch (const exception &e) {
         std::string str_name = online_map.at(client.getFd()).first;
         LOG_INFO << "-------- error: close_cb: str_name = " << str_name << LOG_ENDL;
@@ -152,14 +162,60 @@ void close_cb(const Socket &client, TcpServer *const server) {
         root["username"] = str_name;
         sendHttp(root.toString());  // { "username" : "xiongzp2" }
 
-        map_mutex.lock();
         online_map.erase(client.getFd());
-        map_mutex.unlock();
 
         LOG_ERROR << e.what() << LOG_ENDL;
     }
 }
 
+void idle_cb(const Socket &client, TcpServer *const server) {
+    auto it = online_map.find(client.getFd());
+    if (it == online_map.end()) {
+        return;
+    }
+    if (!it->second.second) {
+        server->disConnect(client);
+        online_map.erase(it);
+        return;
+    }
+    server->sendAll(client, "ping");
+    it->second.second = false;
+}
+
+// 热升级时把在线用户名交给新进程，新进程接管后不会再通知java服务端用户离线
+string upgrade_save_cb(const Socket &client, TcpServer *const) {
+    auto it = online_map.find(client.getFd());
+    return it == online_map.end() ? string() : it->second.first;
+}
+
+void upgrade_restore_cb(const Socket &client, const string &user_name, TcpServer *const) {
+    if (!user_name.empty()) {
+        online_map.emplace(client.getFd(), make_pair(user_name, true));
+    }
+}
+
+// Udp心跳数据报为"pang <会话标识>"，会话有效时刷新对应连接的空闲计时，否则回复"expired"让客户端改回Tcp心跳
+void udp_cb(const AddrInfo &peer, const char *data, size_t len, UdpServer *const server) {
+    static const size_t prefix_len = 5;
+    char session[24] = {0};
+    if (len <= prefix_len || len - prefix_len >= sizeof(session) || memcmp(data, "pang ", prefix_len) != 0) {
+        return;
+    }
+    memcpy(session, data + prefix_len, len - prefix_len);
+    if (!server->touch(strtoull(session, nullptr, 10))) {
+        server->sendTo(peer, "expired");
+    }
+}
+
+void drain_handler(int) {
+    if (glob_server != nullptr) {
+        glob_server->drain(drain_timeout_ms);
+    }
+    if (glob_udp_server != nullptr) {
+        glob_udp_server->stop();
+    }
+}
+
 int main() {
     try {
         glob_config = readConfigFile("server.conf");
@@ -172,36 +228,62 @@ int main() {
     int timeout = glob_config["timeout"].asInt();
     java_server_config = glob_config["java-server"];
     TcpServer server(local_server_port, recv_cb);
-    thread t([&server, timeout]() {
-        while (true) {
-            try {
-                online_map_sendall.clear();
-                map_mutex.lock();
-                online_map_sendall = online_map;
-                map_mutex.unlock();
-                for (auto &i: online_map_sendall) {
-                    if (!i.second.second) {
-                        server.disConnect(i.first);
-                        continue;
-                    }
-                    server.sendAll(i.first, "ping");
-                    i.second.second = false;
-                }
-            } catch (const exception &e) {
-                LOG_ERROR << e.what() << LOG_ENDL;
-            }
-            this_thread::sleep_for(chrono::seconds(timeout));
-        }
-    });
+    server.setIdleTimeout(timeout * 1000, idle_cb);
+    server.setWriteStallTimeout(timeout * 1000);
     server.setCloseCallBack(close_cb);
+    if (glob_config.has("unix-socket")) {
+        server.setListenAddress(AddrInfo::unixPath(glob_config["unix-socket"].asString()));
+    }
+    if (glob_config.has("max-connections")) {
+        server.setMaxConnections(glob_config["max-connections"].asInt());
+    }
+    if (glob_config.has("accept-rate")) {
+        server.setAcceptRate(glob_config["accept-rate"].asInt());
+    }
+    if (glob_config.has("tcp-nodelay")) {
+        SocketOptions options;
+        options.setNoDelay(glob_config["tcp-nodelay"].asBool());
+        server.setSocketOptions(options);
+    }
+    if (glob_config.has("stats-interval")) {
+        // 在主事件循环中定期输出，与回调访问online_map在同一线程
+        server.runEvery(glob_config["stats-interval"].asInt() * 1000, [&server]() {
+            AdmissionStats stats = server.getAdmissionStats();
+            LOG_INFO << "在线用户数：" << online_map.size() << "，当前连接数：" << server.getConnectionCount()
+                     << "，累计接受：" << stats.accepted << "，拒绝：" << stats.rejected << LOG_ENDL;
+        });
+    }
+    if (glob_config.has("upgrade-socket")) {
+        server.setUpgrade(glob_config["upgrade-socket"].asString(), upgrade_save_cb, upgrade_restore_cb);
+    }
     LOG_INFO << "启动socket服务器中于端口：" << local_server_port << LOG_ENDL;
     LOG_INFO << "心跳机制间隔时间：" << timeout << "秒" << LOG_ENDL;
     LOG_DEBUG << "------------------------------------------------------" << LOG_ENDL;
     LOG_INFO << "java服务端url为：http://" << java_server_config["ip"].asString() << ":"
              << java_server_config["port"].asInt() << java_server_config["request-url"].asString()
              << LOG_ENDL;
+    unique_ptr<UdpServer> udp_server;
+    thread udp_thread;
+    if (glob_config.has("udp-port")) {
+        udp_server.reset(new UdpServer(glob_config["udp-port"].asInt(), &server));
+        udp_server->setMessageCallBack(udp_cb);
+        glob_udp_server = udp_server.get();
+        LOG_INFO << "Udp心跳端口：" << glob_config["udp-port"].asInt() << LOG_ENDL;
+        udp_thread = thread([]() {
+            if (!glob_udp_server->run()) {
+                LOG_FAIL << "Udp心跳启动失败：" << glob_udp_server->getError() << LOG_ENDL;
+            }
+        });
+    }
+    glob_server = &server;
+    signal(SIGTERM, drain_handler);
+    signal(SIGINT, drain_handler);
     if (!server.run()) {
         LOG_FAIL << "启动失败：" << server.getError() << LOG_ENDL;
     }
+    if (udp_server != nullptr) {
+        udp_server->stop();
+        udp_thread.join();
+    }
     return 0;
 }
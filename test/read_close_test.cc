@@ -0,0 +1,115 @@
+/*
+ * 回归测试: 客户端写入数据后立即关闭，数据与FIN在同一次事件中到达时，服务端应先交付数据再关闭连接
+ * 在每种IoBackend上运行，边沿触发的epoll曾因读到不足缓冲区大小的数据就停止读取而漏掉FIN，连接永不关闭
+ * 用法: read_close_test [连接数=50]，全部后端通过时返回0
+ */
+#include "CwNetWork/TcpServer.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace std;
+using namespace CwNetWork;
+
+struct Backend {
+    IoBackend backend;
+    const char *name;
+};
+
+static const Backend kBackends[] = {
+        {IoBackend::EPOLL_ET, "epoll-et"},
+        {IoBackend::EPOLL_LT, "epoll-lt"},
+        {IoBackend::POLL,     "poll"},
+        {IoBackend::IO_URING, "io_uring"},
+};
+
+static const unsigned short kBasePort = 19100;
+
+static const char kMessage[] = "hello";
+
+static int connectTo(unsigned short port, const atomic<bool> &exited) {
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (int retry = 0; retry < 200 && !exited.load(); ++retry) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (connect(fd, reinterpret_cast<struct sockaddr *>(&addr), sizeof(addr)) == 0) {
+            return fd;
+        }
+        close(fd);
+        usleep(10000);
+    }
+    return -1;
+}
+
+// 返回0表示通过，1表示失败，-1表示内核不支持该后端
+static int runBackend(const Backend &backend, unsigned short port, int conn_num) {
+    TcpServer server(port, nullptr);
+    server.setIoBackend(backend.backend);
+    atomic<size_t> received{0};
+    atomic<int> closed{0};
+    server.setMessageCallBack([&received](Socket, const char *, size_t len, TcpServer *const) {
+        received += len;
+    });
+    server.setCloseCallBack([&closed](const Socket &, TcpServer *const) {
+        ++closed;
+    });
+    atomic<bool> exited{false};
+    thread runner([&server, &exited]() {
+        server.run();
+        exited = true;
+    });
+    int result = 0;
+    for (int i = 0; i < conn_num; ++i) {
+        int fd = connectTo(port, exited);
+        if (fd == -1) {
+            // 只有io_uring可能因内核不支持而无法运行
+            result = exited.load() && backend.backend == IoBackend::IO_URING ? -1 : 1;
+            fprintf(stderr, "%s: %s, %s\n", backend.name, result == -1 ? "skipped" : "failed to connect",
+                    exited.load() ? server.getError().c_str() : "the server is not accepting");
+            break;
+        }
+        send(fd, kMessage, sizeof(kMessage) - 1, MSG_NOSIGNAL);
+        close(fd);
+    }
+    if (result == 0) {
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(3);
+        while (closed.load() < conn_num && chrono::steady_clock::now() < deadline) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        size_t expected = static_cast<size_t>(conn_num) * (sizeof(kMessage) - 1);
+        if (closed.load() != conn_num || received.load() != expected) {
+            fprintf(stderr, "%s: closed %d/%d connections, received %zu/%zu bytes\n", backend.name,
+                    closed.load(), conn_num, received.load(), expected);
+            result = 1;
+        }
+    }
+    server.stop();
+    runner.join();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int conn_num = argc > 1 ? atoi(argv[1]) : 50;
+    if (conn_num <= 0) {
+        fprintf(stderr, "usage: %s [connections]\n", argv[0]);
+        return 1;
+    }
+    int failed = 0;
+    for (size_t i = 0; i < sizeof(kBackends) / sizeof(kBackends[0]); ++i) {
+        int result = runBackend(kBackends[i], static_cast<unsigned short>(kBasePort + i), conn_num);
+        if (result == 0) {
+            printf("%-10s ok\n", kBackends[i].name);
+        } else if (result == 1) {
+            ++failed;
+        }
+    }
+    return failed;
+}